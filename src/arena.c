@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "src/arena.h"
+#include "src/globals.h"
+
+/*
+ * @brief Round a size up to a multiple of ::ARENA_ALIGNMENT.
+ *
+ * @param size (size_t) A number of bytes.
+ */
+#define ALIGN_SIZE(size) \
+	(((size) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+Arena_t g_frameArena;
+AllocationStats_t g_allocationStats;
+
+/*
+ * @brief Push a new block onto an ::Arena_t.
+ *
+ * @param arena The arena to add the block to.
+ * @param size The minimum number of usable bytes in the block.
+ */
+static void addArenaBlock(Arena_t *arena, size_t size);
+
+void *arenaAlloc(Arena_t *arena, size_t size){
+	size = ALIGN_SIZE(size);
+	ArenaBlock_t *block = arena->blocks;
+	if(block == NULL || block->size - block->used < size){
+		size_t blockSize = (block == NULL)?ARENA_MIN_BLOCK_SIZE:2 * block->size;
+		addArenaBlock(arena, (blockSize < size)?size:blockSize);
+		block = arena->blocks;
+	}
+
+	void *memory = block->data + block->used;
+	block->used += size;
+	g_allocationStats.arenaAllocations++;
+	return memory;
+}
+
+void resetArena(Arena_t *arena){
+	ArenaBlock_t *block = arena->blocks;
+	if(block == NULL)
+		return;
+
+	if(block->next != NULL){
+		size_t size = 0;
+		for(; block != NULL; block = block->next)
+			size += block->size;
+		freeArena(arena);
+		addArenaBlock(arena, size);
+	}
+
+	arena->blocks->used = 0;
+}
+
+void freeArena(Arena_t *arena){
+	ArenaBlock_t *block = arena->blocks;
+	while(block != NULL){
+		ArenaBlock_t *next = block->next;
+		free(block);
+		block = next;
+	}
+	arena->blocks = NULL;
+}
+
+static void addArenaBlock(Arena_t *arena, size_t size){
+	ArenaBlock_t *block;
+	if(posix_memalign((void **)&block, ARENA_ALIGNMENT,
+		sizeof(ArenaBlock_t) + size))
+		FATAL("Failed to allocate an arena block of %zu bytes.", size);
+	g_allocationStats.systemAllocations++;
+
+	block->next = arena->blocks;
+	block->size = size;
+	block->used = 0;
+	arena->blocks = block;
+}
@@ -0,0 +1,79 @@
+/*!
+ *  @file
+ *  @brief A bump allocator for memory that lives for one frame.
+ *
+ *  The render pipeline's temporaries (generated vertices, normals, vertex
+ *  colors) are allocated from ::g_frameArena by advancing a pointer, and are
+ *  all released at once by ::resetArena() at the end of each frame. After the
+ *  first few frames the arena's single block is large enough for any frame,
+ *  so a steady-state frame makes no calls into the system allocator.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+// The byte alignment of every arena allocation; a multiple of
+// ::MATRIX_ALIGNMENT, so that arena-backed ::Matrix_t can be vectorized.
+#define ARENA_ALIGNMENT 32
+
+// The size of the first block an ::Arena_t allocates, in bytes.
+#define ARENA_MIN_BLOCK_SIZE (1 << 20)
+
+//! A block of memory that an ::Arena_t hands out.
+typedef struct ArenaBlock_t {
+	struct ArenaBlock_t *next; //! The block filled up before this one.
+	size_t size; //! The number of bytes in ::data.
+	size_t used; //! The number of bytes of ::data handed out.
+	_Alignas(ARENA_ALIGNMENT) char data[]; //! The block's memory.
+} ArenaBlock_t;
+
+//! A bump allocator; zero-initialize to create an empty one.
+typedef struct {
+	ArenaBlock_t *blocks; //! The block being allocated from, then older ones.
+} Arena_t;
+
+//! Counts of the engine's allocations.
+typedef struct {
+	long arenaAllocations; //! Calls to ::arenaAlloc().
+	long systemAllocations; //! Calls into malloc() and its relatives.
+} AllocationStats_t;
+
+//! The arena for memory that's released at the end of every frame.
+extern Arena_t g_frameArena;
+
+/*!
+ *  Allocation counts since the program started. System allocations are
+ *  counted where the render pipeline makes them: by ::Arena_t, ::Matrix_t,
+ *  ::Mesh_t and the interpreter's transformation stack.
+ */
+extern AllocationStats_t g_allocationStats;
+
+/*!
+ *  @brief Allocate memory from an ::Arena_t.
+ *
+ *  @param arena The arena to allocate from.
+ *  @param size The number of bytes to allocate.
+ *
+ *  @return A pointer to @p size bytes, aligned to ::ARENA_ALIGNMENT, that
+ *      remain valid until @p arena is reset.
+ */
+void *arenaAlloc(Arena_t *arena, size_t size);
+
+/*!
+ *  @brief Release every allocation made from an ::Arena_t.
+ *
+ *  If the arena had to allocate more than one block since it was last reset,
+ *  they're replaced by a single block as large as all of them together, so
+ *  the next frame of the same size fits in it.
+ *
+ *  @param arena The arena to reset; its memory is kept for reuse.
+ */
+void resetArena(Arena_t *arena);
+
+/*!
+ *  @brief Return an ::Arena_t's memory to the system.
+ *
+ *  @param arena The arena to free; it's left empty, and may be reused.
+ */
+void freeArena(Arena_t *arena);
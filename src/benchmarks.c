@@ -0,0 +1,893 @@
+/*!
+ *  @file
+ *  @brief Micro-benchmarks for the engine's hot paths.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "src/arena.h"
+#include "src/fast_math.h"
+#include "src/globals.h"
+#include "src/benchmarks.h"
+#include "src/graphics/camera.h"
+#include "src/graphics/cull.h"
+#include "src/graphics/curve.h"
+#include "src/graphics/geometry.h"
+#include "src/graphics/graphics.h"
+#include "src/graphics/matrix.h"
+#include "src/graphics/mesh.h"
+#include "src/graphics/screen.h"
+#include "src/graphics/tessellation.h"
+#include "src/graphics/tiles.h"
+#include "src/graphics/transform.h"
+
+/*!
+ *  @brief Time a block of code, and print the result.
+ *
+ *  Execute the code in ... @p reps times, and print its average running time
+ *  in milliseconds, along with its speedup over @p baseline. The average is
+ *  stored in @p result.
+ *
+ *  @param name (const char *) The benchmark's name.
+ *  @param reps (int) The number of times to execute ....
+ *  @param baseline (double) The average time of the reference implementation,
+ *      in milliseconds; 0 if this is the reference.
+ *  @param result (double) Set to the average time, in milliseconds.
+ */
+#define BENCH(name, reps, baseline, result, ...) \
+	do {\
+		double start = currentTime();\
+		int rep;\
+		for(rep = 0; rep < reps; rep++){\
+			__VA_ARGS__\
+		}\
+		result = (currentTime() - start) / reps;\
+		if(baseline > 0)\
+			printf("Benchmark %-40s %10.3f ms (%.2fx)\n", name, result,\
+				baseline / result);\
+		else\
+			printf("Benchmark %-40s %10.3f ms\n", name, result);\
+	} while(0)
+
+//! The number of times each benchmark is repeated.
+#define BENCH_REPETITIONS 20
+
+// The dimensions of the off-screen ::ZBuffer_t that rendering benchmarks use.
+#define BENCH_SCREEN_WIDTH 800
+#define BENCH_SCREEN_HEIGHT 700
+
+extern int g_screenWidth, g_screenHeight;
+extern ZBuffer_t *g_zbuffer;
+
+/*
+ * @brief Return a monotonic timestamp.
+ *
+ * @return The current time in milliseconds.
+ */
+static double currentTime(void);
+
+/*
+ * @brief Multiply ::Matrix_t @p m1 into ::Matrix_t @p m2, one dot-product at a
+ *      time.
+ *
+ * The original ::multiplyMatrix() loop, kept as a baseline for the vertex
+ * kernels.
+ *
+ * @param m1 ::Matrix_t to be multiplied into @p m2.
+ * @param m2 ::Matrix_t to contain the product of the original @p m1 and @p m2.
+ */
+static void legacyMultiplyMatrix(Matrix_t *m1, Matrix_t *m2);
+
+/*
+ * @brief Draw a horizontal line with an interpolated color gradient, one
+ *      division and ::plotPixel() per pixel.
+ *
+ * The original ::drawHorizontalGradientLine() loop, kept as a baseline for the
+ * incremental one.
+ *
+ * @param light1 The leftmost endpoint.
+ * @param light2 The rightmost endpoint.
+ */
+static void legacyGradientLine(Light_t *light1, Light_t *light2);
+
+/*
+ * @brief Benchmark ::transform::applyMat4() with every vertex kernel.
+ */
+static void benchVertexKernels(void);
+
+/*
+ * @brief Benchmark a chain of transformations applied one by one, against
+ *      ::transform::applyMat4Chain().
+ */
+static void benchTransformChain(void);
+
+/*
+ * @brief Benchmark transforming a sphere as a triangle list, against
+ *      transforming the unique vertices of its ::Mesh_t.
+ */
+static void benchMesh(void);
+
+/*
+ * @brief Benchmark adding a torus to a mesh, with and without a cache hit.
+ */
+static void benchTessellationCache(void);
+
+/*
+ * @brief Benchmark ::drawMatrix() on a scene of a box, sphere and torus, and
+ *      report its throughput in triangles per second.
+ */
+static void benchDrawMatrix(void);
+
+/*
+ * @brief Benchmark rendering a sphere's triangle list with ::drawMatrix(),
+ *      against rendering its ::Mesh_t, lit per vertex, with ::drawMesh().
+ */
+static void benchDrawMesh(void);
+
+/*
+ * @brief Benchmark drawing a Bezier curve from ::addBezier()'s fixed samples,
+ *      against drawing its adaptively flattened polyline.
+ */
+static void benchCurves(void);
+
+/*
+ * @brief Benchmark ::drawMesh() with exact math, against fast math.
+ */
+static void benchFastMath(void);
+
+/*
+ * @brief Benchmark ::drawMatrix() with the scanline rasterizer, against the
+ *      edge rasterizer, on a scene of a box, sphere and torus.
+ */
+static void benchRasterizers(void);
+
+/*
+ * @brief Benchmark ::drawMatrix() on one thread, against one thread per
+ *      online processor (at least two), rasterizing the screen's tiles.
+ */
+static void benchTiledRendering(void);
+
+/*
+ * @brief Benchmark filling the screen with gradient spans the original way,
+ *      against ::drawHorizontalGradientLine().
+ */
+static void benchGradientSpans(void);
+
+/*
+ * @brief Benchmark ::drawMatrix() with either rasterizer, and ::drawLine(), on
+ *      geometry that reaches far past the edges of the screen.
+ */
+static void benchClipping(void);
+
+/*
+ * @brief Benchmark ::drawMatrix() on a sphere and torus hidden behind a wall,
+ *      without and with the coarse depth test, and report what it rejected.
+ */
+static void benchDepthCulling(void);
+
+/*
+ * @brief Benchmark drawing spheres spread all around a perspective camera,
+ *      without and with frustum culling.
+ */
+static void benchFrustumCulling(void);
+
+/*
+ * @brief Benchmark ::drawMatrix() with every triangle tested as it's drawn,
+ *      against the batched culling stage, on a scene where most triangles are
+ *      culled; and ::cullTriangles() alone with each kernel.
+ */
+static void benchTriangleCulling(void);
+
+/*
+ * @brief Benchmark clearing and reading back the z-buffer's packed planes,
+ *      against the per-pixel allocations it replaced.
+ */
+static void benchZBufferLayout(void);
+
+/*
+ * @brief Benchmark drawing and clearing frames of a small sprite, with every
+ *      pixel cleared each frame, against ::clearZBuffer()'s lazy clear.
+ */
+static void benchLazyClear(void);
+
+/*
+ * @brief Benchmark presenting frames of a small sprite by copying every pixel
+ *      into a screen surface, against collecting ::takeDirtyRects().
+ */
+static void benchPresentation(void);
+
+static double currentTime(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1e3 + now.tv_nsec / 1e6;
+}
+
+static void legacyMultiplyMatrix(Matrix_t *m1, Matrix_t *m2){
+	int col;
+	for(col = 0; col < m2->numPoints; col++){
+		Point_t *point = m2->points[col];
+
+		Point_t dots[4];
+		int row;
+		for(row = 0; row < 4; row++)
+			dots[row] = dotProduct(POINT(m1->points[0][row],
+				m1->points[1][row], m1->points[2][row], m1->points[3][row]),
+				point);
+
+		point[X] = dots[X];
+		point[Y] = dots[Y];
+		point[Z] = dots[Z];
+		point[W] = dots[W];
+	}
+}
+
+static void legacyGradientLine(Light_t *light1, Light_t *light2){
+	Point_t *guide = COPY_POINT(light1->pos);
+	for(; guide[X] < light2->pos[X]; guide[X]++){
+		Point_t divisor = 1 / (light2->pos[X] - light1->pos[X]),
+			coef1 = divisor * (light2->pos[X] - guide[X]),
+			coef2 = divisor * (guide[X] - light1->pos[X]);
+		RGB_t color[3];
+		int channel;
+		for(channel = 0; channel < 3; channel++)
+			color[channel] = coef1 * light1->color[channel] +
+				coef2 * light2->color[channel];
+		plotPixel(guide, (color[R] << 16) + (color[G] << 8) + color[B]);
+	}
+}
+
+static void legacyClearZBuffer(ZBuffer_t *zBuf){
+	int numPixels = g_screenWidth * g_screenHeight, pixel;
+	for(pixel = 0; pixel < numPixels; pixel++)
+		zBuf->depth[pixel] = ZBUFFER_EMPTY;
+	memset(zBuf->color, 0, numPixels * sizeof(*zBuf->color));
+
+	int numTiles = zBuf->tileColumns *
+		((g_screenHeight + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE), tile;
+	for(tile = 0; tile < numTiles; tile++){
+		zBuf->tiles[tile].empty = zBuf->tiles[tile].pixels;
+		zBuf->tiles[tile].misses = 0;
+		zBuf->tiles[tile].farthest = ZBUFFER_EMPTY;
+	}
+}
+
+static void legacyRenderScreen(uint8_t *pixels, int pitch){
+	flushZBuffer(g_zbuffer);
+	int y, x;
+	for(y = 0; y < g_screenHeight; y++){
+		uint32_t *row = &g_zbuffer->color[ZBUFFER_PIXEL(g_zbuffer, 0, y)];
+		for(x = 0; x < g_screenWidth; x++)
+			*(uint32_t *)(pixels + y * pitch + x * sizeof(uint32_t)) = row[x];
+	}
+}
+
+static void benchVertexKernels(void){
+	Matrix_t *points = createMatrix();
+	addSphere(points, POINT(0, 0), 200);
+	printf("\nTransforming %d points:\n", points->numPoints);
+
+	// a transformation that maps the points back onto themselves, to keep
+	// them from blowing up over repetitions
+	Matrix_t *rotation = createRotation(Y_AXIS, 360.0 / BENCH_REPETITIONS);
+	Mat4_t transform = mat4FromMatrix(rotation);
+
+	double baseline, result;
+	BENCH("legacy multiplyMatrix loop", BENCH_REPETITIONS, 0, baseline,
+		legacyMultiplyMatrix(rotation, points);
+	);
+
+	const char *names[] = {"scalar kernel", "SSE2 kernel", "AVX kernel"};
+	int kernel;
+	for(kernel = VERTEX_KERNEL_SCALAR; kernel <= VERTEX_KERNEL_AVX; kernel++){
+		if(!setVertexKernel(kernel))
+			continue;
+
+		BENCH(names[kernel], BENCH_REPETITIONS, baseline, result,
+			applyMat4(&transform, points);
+		);
+	}
+
+	setVertexKernel(VERTEX_KERNEL_AUTO);
+	freeMatrices(2, rotation, points);
+}
+
+static void benchTransformChain(void){
+	Matrix_t *points = createMatrix();
+	addTorus(points, POINT(0, 0), 100, 200);
+	printf("\nTransforming %d points by 3 rotations:\n", points->numPoints);
+
+	Mat4_t chain[] = {
+		rotationMat4(X_AXIS, 1),
+		rotationMat4(Y_AXIS, 1),
+		rotationMat4(Z_AXIS, 1)
+	};
+
+	double baseline, result;
+	BENCH("one pass per transformation", BENCH_REPETITIONS, 0, baseline,
+		applyMat4(&chain[0], points);
+		applyMat4(&chain[1], points);
+		applyMat4(&chain[2], points);
+	);
+
+	BENCH("applyMat4Chain", BENCH_REPETITIONS, baseline, result,
+		applyMat4Chain(3, chain, points);
+	);
+
+	freeMatrix(points);
+}
+
+static void benchMesh(void){
+	Mesh_t *mesh = createMesh();
+	addSphereMesh(mesh, POINT(0, 0), 200);
+	Matrix_t *points = createMatrix();
+	addMesh(points, mesh);
+	printf("\nTransforming a sphere of %d triangles:\n", mesh->numIndices / 3);
+
+	Mat4_t rotation = rotationMat4(Y_AXIS, 360.0 / BENCH_REPETITIONS);
+
+	double baseline, result;
+	BENCH("triangle list", BENCH_REPETITIONS, 0, baseline,
+		applyMat4(&rotation, points);
+	);
+
+	BENCH("indexed mesh", BENCH_REPETITIONS, baseline, result,
+		applyMat4(&rotation, mesh->vertices);
+	);
+
+	freeMatrix(points);
+	freeMesh(mesh);
+}
+
+static void benchTessellationCache(void){
+	Mesh_t *mesh = createMesh();
+	addTorusMesh(mesh, POINT(0, 0), 40, 120);
+	printf("\nAdding a torus of %d triangles to a mesh:\n",
+		mesh->numIndices / 3);
+
+	double baseline, result;
+	BENCH("tessellated every time", BENCH_REPETITIONS, 0, baseline,
+		clearTessellationCache(&g_tessellationCache);
+		addTorusMesh(mesh, POINT(0, 0), 40, 120);
+		clearMesh(mesh);
+		resetArena(&g_frameArena);
+	);
+
+	BENCH("copied from the cache", BENCH_REPETITIONS, baseline, result,
+		addTorusMesh(mesh, POINT(0, 0), 40, 120);
+		clearMesh(mesh);
+		resetArena(&g_frameArena);
+	);
+
+	freeMesh(mesh);
+}
+
+static void benchDrawMatrix(void){
+	Matrix_t *points = createMatrix();
+	addRectangularPrism(points, POINT(-150, 150, 300), POINT(100, 100, 100));
+	addSphere(points, POINT(0, 0, 0), 150);
+	addTorus(points, POINT(100, 100, 200), 40, 120);
+	int numTriangles = points->numPoints / 3;
+	printf("\nRendering a scene of %d triangles:\n", numTriangles);
+
+	double result;
+	BENCH("drawMatrix", BENCH_REPETITIONS, 0, result,
+		drawMatrix(points);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+	printf("%-50s %10.0f triangles/s\n", "", numTriangles / result * 1e3);
+
+	freeMatrix(points);
+}
+
+static void benchDrawMesh(void){
+	Mesh_t *mesh = createMesh();
+	addSphereMesh(mesh, POINT(0, 0), 200);
+	Matrix_t *points = createMatrix();
+	addMesh(points, mesh);
+	printf("\nRendering a sphere of %d triangles (%d unique vertices):\n",
+		mesh->numIndices / 3, mesh->vertices->numPoints);
+
+	double baseline, result;
+	BENCH("drawMatrix", BENCH_REPETITIONS, 0, baseline,
+		drawMatrix(points);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	BENCH("drawMesh", BENCH_REPETITIONS, baseline, result,
+		drawMesh(mesh);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	freeMatrix(points);
+	freeMesh(mesh);
+}
+
+static void benchCurves(void){
+	Matrix_t *points = createMatrix();
+	flattenBezier(points, POINT(-300, -200), POINT(-100, 300), POINT(100, -300),
+		POINT(300, 200));
+	printf("\nDrawing a Bezier curve (%d flattened vertices):\n",
+		points->numPoints);
+
+	double baseline, result;
+	BENCH("addBezier samples", BENCH_REPETITIONS, 0, baseline,
+		addBezier(points, POINT(-300, -200), POINT(-100, 300),
+			POINT(100, -300), POINT(300, 200));
+		drawPolyline(points, TEST_COLOR);
+		CLEAR(points);
+		resetArena(&g_frameArena);
+	);
+
+	BENCH("flattenBezier", BENCH_REPETITIONS, baseline, result,
+		flattenBezier(points, POINT(-300, -200), POINT(-100, 300),
+			POINT(100, -300), POINT(300, 200));
+		drawPolyline(points, TEST_COLOR);
+		CLEAR(points);
+		resetArena(&g_frameArena);
+	);
+
+	clearZBuffer(g_zbuffer);
+	freeMatrix(points);
+}
+
+static void benchFastMath(void){
+	Mesh_t *mesh = createMesh();
+	addSphereMesh(mesh, POINT(0, 0), 200);
+	printf("\nLighting and rendering a sphere of %d unique vertices:\n",
+		mesh->vertices->numPoints);
+
+	int fastMath = g_fastMath;
+	double baseline, result;
+	g_fastMath = 0;
+	BENCH("exact math", BENCH_REPETITIONS, 0, baseline,
+		drawMesh(mesh);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	g_fastMath = 1;
+	BENCH("fast math", BENCH_REPETITIONS, baseline, result,
+		drawMesh(mesh);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	g_fastMath = fastMath;
+	freeMesh(mesh);
+}
+
+static void benchRasterizers(void){
+	Matrix_t *points = createMatrix();
+	addRectangularPrism(points, POINT(-150, 150, 300), POINT(100, 100, 100));
+	addSphere(points, POINT(0, 0, 0), 150);
+	addTorus(points, POINT(100, 100, 200), 40, 120);
+	printf("\nRasterizing a scene of %d triangles:\n", points->numPoints / 3);
+
+	int rasterizer = g_rasterizer;
+	double baseline, result;
+	g_rasterizer = RASTERIZER_SCANLINE;
+	BENCH("scanline rasterizer", BENCH_REPETITIONS, 0, baseline,
+		drawMatrix(points);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	g_rasterizer = RASTERIZER_EDGE;
+	BENCH("edge rasterizer", BENCH_REPETITIONS, baseline, result,
+		drawMatrix(points);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	CLEAR(points);
+	addRectangularPrism(points, POINT(-300, 300, 300), POINT(600, 600, 600));
+	printf("\nRasterizing a box of %d triangles:\n", points->numPoints / 3);
+
+	g_rasterizer = RASTERIZER_SCANLINE;
+	BENCH("scanline rasterizer", BENCH_REPETITIONS, 0, baseline,
+		drawMatrix(points);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	g_rasterizer = RASTERIZER_EDGE;
+	BENCH("edge rasterizer", BENCH_REPETITIONS, baseline, result,
+		drawMatrix(points);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	g_rasterizer = rasterizer;
+	freeMatrix(points);
+}
+
+static void benchTiledRendering(void){
+	Matrix_t *points = createMatrix();
+	addRectangularPrism(points, POINT(-150, 150, 300), POINT(100, 100, 100));
+	addSphere(points, POINT(0, 0, 0), 150);
+	addTorus(points, POINT(100, 100, 200), 40, 120);
+	addRectangularPrism(points, POINT(-300, 300, -300), POINT(600, 600, 100));
+
+	long processors = sysconf(_SC_NPROCESSORS_ONLN);
+	int threads = (processors < 2)?2:(processors > MAX_RENDER_THREADS)?
+		MAX_RENDER_THREADS:processors;
+	printf("\nRendering a scene of %d triangles on %d threads:\n",
+		points->numPoints / 3, threads);
+
+	int renderThreads = g_renderThreads;
+	double baseline, result;
+	g_renderThreads = 1;
+	BENCH("one thread", BENCH_REPETITIONS, 0, baseline,
+		drawMatrix(points);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	g_renderThreads = threads;
+	BENCH("tiles", BENCH_REPETITIONS, baseline, result,
+		drawMatrix(points);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	g_renderThreads = renderThreads;
+	stopRenderThreads();
+	freeMatrix(points);
+}
+
+static void benchGradientSpans(void){
+	printf("\nFilling %d gradient spans of %d pixels:\n", g_screenHeight,
+		g_screenWidth);
+
+	Light_t left = {.color = RGB(0xFF, 0x40, 0x00)},
+		right = {.color = RGB(0x00, 0x80, 0xFF)};
+	double baseline, result;
+	int row;
+	BENCH("per-pixel interpolation", BENCH_REPETITIONS, 0, baseline,
+		for(row = 0; row < g_screenHeight; row++){
+			left.pos = POINT(-g_screenWidth / 2 + 0.3,
+				row - g_screenHeight / 2);
+			right.pos = POINT(g_screenWidth / 2 - 0.3,
+				row - g_screenHeight / 2);
+			legacyGradientLine(&left, &right);
+		}
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	BENCH("drawHorizontalGradientLine", BENCH_REPETITIONS, baseline, result,
+		for(row = 0; row < g_screenHeight; row++){
+			left.pos = POINT(-g_screenWidth / 2 + 0.3,
+				row - g_screenHeight / 2);
+			right.pos = POINT(g_screenWidth / 2 - 0.3,
+				row - g_screenHeight / 2);
+			drawHorizontalGradientLine(&left, &right);
+		}
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+}
+
+static void benchClipping(void){
+	Matrix_t *scene = createMatrix();
+	addRectangularPrism(scene, POINT(-150, 150, 300), POINT(100, 100, 100));
+	addSphere(scene, POINT(0, 0, 0), 150);
+	addTorus(scene, POINT(100, 100, 200), 40, 120);
+
+	int rasterizer = g_rasterizer;
+	double zooms[] = {40, 10000}, result;
+	int zoom;
+	for(zoom = 0; zoom < 2; zoom++){
+		Matrix_t *points = copyMatrix(scene);
+		Mat4_t scale = scaleMat4(POINT(zooms[zoom], zooms[zoom], zooms[zoom]));
+		applyMat4(&scale, points);
+		printf("\nRendering a scene of %d triangles, zoomed in %.0fx:\n",
+			points->numPoints / 3, zooms[zoom]);
+
+		g_rasterizer = RASTERIZER_SCANLINE;
+		BENCH("scanline rasterizer", BENCH_REPETITIONS, 0, result,
+			drawMatrix(points);
+			clearZBuffer(g_zbuffer);
+			resetArena(&g_frameArena);
+		);
+
+		g_rasterizer = RASTERIZER_EDGE;
+		BENCH("edge rasterizer", BENCH_REPETITIONS, 0, result,
+			drawMatrix(points);
+			clearZBuffer(g_zbuffer);
+			resetArena(&g_frameArena);
+		);
+		freeMatrix(points);
+	}
+	g_rasterizer = rasterizer;
+
+	printf("\nDrawing 100 lines, each a million pixels long:\n");
+	int line;
+	BENCH("drawLine", BENCH_REPETITIONS, 0, result,
+		for(line = 0; line < 100; line++)
+			drawLine(POINT(-500000, line * 7 - 350),
+				POINT(500000, 350 - line * 7));
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	freeMatrix(scene);
+}
+
+static void benchDepthCulling(void){
+	Matrix_t *points = createMatrix();
+	addRectangularPrism(points, POINT(-350, 300, 400), POINT(700, 600, 50));
+	addSphere(points, POINT(0, 0, 0), 150);
+	addTorus(points, POINT(100, 100, 200), 40, 120);
+	printf("\nRendering %d triangles, mostly behind a wall:\n",
+		points->numPoints / 3);
+
+	int depthCulling = g_depthCulling;
+	double baseline, result;
+	g_depthCulling = 0;
+	BENCH("no coarse depth test", BENCH_REPETITIONS, 0, baseline,
+		drawMatrix(points);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	g_depthCulling = 1;
+	g_depthStats = (DepthStats_t){0};
+	BENCH("coarse depth test", BENCH_REPETITIONS, baseline, result,
+		drawMatrix(points);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+	printf("%-50s %10ld of %ld triangles, %ld pixels rejected\n", "",
+		g_depthStats.trianglesRejected / BENCH_REPETITIONS,
+		g_depthStats.triangles / BENCH_REPETITIONS,
+		g_depthStats.pixelsRejected / BENCH_REPETITIONS);
+
+	g_depthCulling = depthCulling;
+	freeMatrix(points);
+}
+
+static void benchFrustumCulling(void){
+	Mesh_t *mesh = createMesh();
+	Mat4_t identity = identityMat4(), lod;
+	g_camera = perspectiveCamera(POINT(0, 0, 600), POINT(0, 0, 0), 0);
+
+	// a grid of spheres, most of them beside or behind the camera
+	int x, z, numSpheres = 0, visible = 0;
+	for(x = -2000; x <= 2000; x += 200)
+		for(z = -3800; z <= 4000; z += 200)
+			numSpheres++;
+	printf("\nRendering %d spheres spread around a camera:\n", numSpheres);
+
+	double baseline, result;
+	BENCH("no frustum culling", BENCH_REPETITIONS, 0, baseline,
+		for(x = -2000; x <= 2000; x += 200)
+			for(z = -3800; z <= 4000; z += 200){
+				addSphereMeshLOD(mesh, POINT(x, 100, z), 40, &identity);
+				drawMesh(mesh);
+				clearMesh(mesh);
+			}
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	BENCH("frustum culling", BENCH_REPETITIONS, baseline, result,
+		for(x = -2000; x <= 2000; x += 200)
+			for(z = -3800; z <= 4000; z += 200){
+				if(!sphereInView(&g_camera, POINT(x, 100, z), 40, &identity,
+					&lod))
+					continue;
+				addSphereMeshLOD(mesh, POINT(x, 100, z), 40, &lod);
+				drawMesh(mesh);
+				clearMesh(mesh);
+				visible++;
+			}
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+	printf("%-50s %10d of %d spheres drawn\n", "",
+		visible / BENCH_REPETITIONS, numSpheres);
+
+	g_camera = orthographicCamera();
+	freeMesh(mesh);
+}
+
+static void benchTriangleCulling(void){
+	// a sphere straddling the screen's edge, half of it facing away, and a
+	// field of spheres smaller than a pixel
+	Matrix_t *points = createMatrix();
+	addSphere(points, POINT(400, 0, 0), 300);
+	int x, y;
+	for(x = -380; x <= 380; x += 40)
+		for(y = -330; y <= 330; y += 40)
+			addSphere(points, POINT(x, y, -400), 0.3);
+	int numTriangles = points->numPoints / 3;
+	printf("\nCulling %d triangles:\n", numTriangles);
+
+	double baseline, result;
+	BENCH("drawTriangle loop", BENCH_REPETITIONS, 0, baseline,
+		int vertex;
+		for(vertex = 0; vertex < points->numPoints; vertex += 3)
+			drawTriangle(points->points[vertex], points->points[vertex + 1],
+				points->points[vertex + 2]);
+		clearZBuffer(g_zbuffer);
+	);
+
+	g_cullStats = (CullStats_t){0};
+	BENCH("drawMatrix, culled in a batch", BENCH_REPETITIONS, baseline, result,
+		drawMatrix(points);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+	printf("%-50s %10ld backfacing, %ld degenerate, %ld off-screen, "
+		"%ld sub-pixel\n", "",
+		g_cullStats.culled[CULL_BACKFACE] / BENCH_REPETITIONS,
+		g_cullStats.culled[CULL_DEGENERATE] / BENCH_REPETITIONS,
+		g_cullStats.culled[CULL_OFFSCREEN] / BENCH_REPETITIONS,
+		g_cullStats.culled[CULL_SUBPIXEL] / BENCH_REPETITIONS);
+
+	int *survivors = malloc(numTriangles * sizeof(int));
+	const char *names[] = {"scalar cull kernel", "SSE2 cull kernel"};
+	int kernel;
+	for(kernel = CULL_KERNEL_SCALAR; kernel <= CULL_KERNEL_SSE2; kernel++){
+		if(!setCullKernel(kernel))
+			continue;
+		BENCH(names[kernel], BENCH_REPETITIONS,
+			(kernel == CULL_KERNEL_SCALAR)?0:baseline, result,
+			cullTriangles(points->points, NULL, numTriangles, survivors);
+			resetArena(&g_frameArena);
+		);
+		if(kernel == CULL_KERNEL_SCALAR)
+			baseline = result;
+	}
+	setCullKernel(CULL_KERNEL_AUTO);
+
+	free(survivors);
+	freeMatrix(points);
+}
+
+static void benchZBufferLayout(void){
+	int width = g_screenWidth, height = g_screenHeight, y, x;
+	double ***legacy = malloc(height * sizeof(double **));
+	for(y = 0; y < height; y++){
+		legacy[y] = malloc(width * sizeof(double *));
+		for(x = 0; x < width; x++)
+			legacy[y][x] = malloc(2 * sizeof(double));
+	}
+	// read back into a row, as ::renderScreen() does; kept live by `sink`
+	uint32_t *row = malloc(width * sizeof(uint32_t));
+	volatile uint32_t sink = 0;
+	printf("\nClearing a %dx%d z-buffer:\n", width, height);
+
+	double baseline, result;
+	BENCH("per-pixel arrays", BENCH_REPETITIONS, 0, baseline,
+		for(y = 0; y < height; y++)
+			for(x = 0; x < width; x++){
+				legacy[y][x][0] = 0;
+				legacy[y][x][1] = -1;
+			}
+	);
+
+	BENCH("packed planes", BENCH_REPETITIONS, baseline, result,
+		legacyClearZBuffer(g_zbuffer);
+	);
+
+	printf("\nReading back a %dx%d z-buffer's colors:\n", width, height);
+	BENCH("per-pixel arrays", BENCH_REPETITIONS, 0, baseline,
+		for(y = 0; y < height; y++){
+			for(x = 0; x < width; x++){
+				int color = legacy[y][x][1];
+				row[x] = color == -1 ? 0 : color;
+			}
+			sink ^= row[width - 1];
+		}
+	);
+
+	BENCH("packed planes", BENCH_REPETITIONS, baseline, result,
+		for(y = 0; y < height; y++){
+			memcpy(row, &g_zbuffer->color[ZBUFFER_PIXEL(g_zbuffer, 0, y)],
+				width * sizeof(uint32_t));
+			sink ^= row[width - 1];
+		}
+	);
+
+	for(y = 0; y < height; y++){
+		for(x = 0; x < width; x++)
+			free(legacy[y][x]);
+		free(legacy[y]);
+	}
+	free(legacy);
+	free(row);
+}
+
+static void benchLazyClear(void){
+	Matrix_t *sprite = createMatrix();
+	addSphere(sprite, POINT(0, 0, 0), 20);
+	printf("\nDrawing and clearing a %d-triangle sprite on a %dx%d screen:\n",
+		sprite->numPoints / 3, g_screenWidth, g_screenHeight);
+
+	double baseline, result;
+	flushZBuffer(g_zbuffer);
+	BENCH("clearing every pixel", BENCH_REPETITIONS, 0, baseline,
+		drawMatrix(sprite);
+		legacyClearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	BENCH("clearZBuffer", BENCH_REPETITIONS, baseline, result,
+		drawMatrix(sprite);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	freeMatrix(sprite);
+}
+
+static void benchPresentation(void){
+	Matrix_t *sprite = createMatrix();
+	addSphere(sprite, POINT(0, 0, 0), 20);
+	int pitch = g_screenWidth * sizeof(uint32_t),
+		numTiles = g_zbuffer->tileColumns *
+			((g_screenHeight + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE);
+	uint8_t *pixels = malloc(pitch * g_screenHeight);
+	PixelRect_t *rects = malloc(numTiles * sizeof(PixelRect_t));
+	printf("\nPresenting a %d-triangle sprite on a %dx%d screen:\n",
+		sprite->numPoints / 3, g_screenWidth, g_screenHeight);
+
+	double baseline, result;
+	int numRects = 0;
+	BENCH("copying every pixel", BENCH_REPETITIONS, 0, baseline,
+		drawMatrix(sprite);
+		legacyRenderScreen(pixels, pitch);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+
+	BENCH("takeDirtyRects", BENCH_REPETITIONS, baseline, result,
+		drawMatrix(sprite);
+		numRects = takeDirtyRects(g_zbuffer, rects);
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+	);
+	printf("%-50s %10d rectangles per frame\n", "", numRects);
+
+	takeDirtyRects(g_zbuffer, rects);
+	freeMatrix(sprite);
+	free(pixels);
+	free(rects);
+}
+
+int benchmarks(void){
+	setvbuf(stdout, NULL, _IONBF, 0);
+	puts("Begin benchmarks.");
+	benchVertexKernels();
+	benchTransformChain();
+	benchMesh();
+	benchTessellationCache();
+
+	g_screenWidth = BENCH_SCREEN_WIDTH;
+	g_screenHeight = BENCH_SCREEN_HEIGHT;
+	g_zbuffer = createZBuffer();
+	benchDrawMatrix();
+	benchDrawMesh();
+	benchCurves();
+	benchFastMath();
+	benchGradientSpans();
+	benchRasterizers();
+	benchTiledRendering();
+	benchClipping();
+	benchDepthCulling();
+	benchFrustumCulling();
+	benchTriangleCulling();
+	benchZBufferLayout();
+	benchLazyClear();
+	benchPresentation();
+	freeZBuffer(g_zbuffer);
+	return 0;
+}
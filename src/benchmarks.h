@@ -0,0 +1,13 @@
+/*!
+ *  @file
+ *  @brief Micro-benchmarks for the engine's hot paths.
+ */
+
+#pragma once
+
+/*!
+ * @brief Execute all benchmarks; print their timings to the console.
+ *
+ * @return 0 on successful completion of all benchmarks.
+ */
+int benchmarks(void);
@@ -12,19 +12,28 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "src/arena.h"
+#include "src/fast_math.h"
 #include "src/globals.h"
+#include "src/benchmarks.h"
 #include "src/graphics/screen.h"
 #include "src/unit_tests.h"
 #include "src/graphics/geometry.h"
 #include "src/graphics/graphics.h"
 #include "src/graphics/matrix.h"
+#include "src/graphics/tiles.h"
+#include "src/graphics/transform.h"
 #include "src/interpreter/file_parser.h"
 #include "src/interpreter/stack/stack.h"
 
 #include "lib/parser.h"
 
 #define TEST_CMD "--test"
+#define BENCH_CMD "--bench"
 #define SCRIPT_CMD "--script"
+#define FAST_CMD "--fast"
+#define EDGE_CMD "--edge"
+#define THREADS_CMD "--threads"
 
 /*
  * @brief Display a sample animation.
@@ -35,9 +44,14 @@ static void sampleAnimation();
  *  @brief Handle command-line arguments.
  *
  *  Respond to any command-line arguments:
+ *      0. if the first arguments are FAST_CMD, which sets ::g_fastMath, or
+ *          EDGE_CMD, which sets ::g_rasterizer to ::RASTERIZER_EDGE, or
+ *          THREADS_CMD and a thread count, which sets ::g_renderThreads,
+ *          respond to the rest as below.
  *      1. if no arguments are passed, start the engine's shell.
  *      2. if the command is TEST_CMD, run all unit tests.
- *      3. if the command is SCRIPT_CMD, evaluate the script file at the
+ *      3. if the command is BENCH_CMD, run all benchmarks.
+ *      4. if the command is SCRIPT_CMD, evaluate the script file at the
  *          location specified by the subsequent argument.
  *
  *  Exit with an error code of 1 should unrecognized or insufficient arguments
@@ -68,30 +82,62 @@ static void sampleAnimation(){
 	configureScreen();
 	Matrix_t *pts = createMatrix();
 	addTorus(pts, POINT(0, 0), 100, 200);
-	Matrix_t *rX = createRotation(X_AXIS, 1),
-		*rY = createRotation(Y_AXIS, 1),
-		*rZ = createRotation(Z_AXIS, 1);
+	Mat4_t rotations[] = {
+		rotationMat4(X_AXIS, 1),
+		rotationMat4(Y_AXIS, 1),
+		rotationMat4(Z_AXIS, 1)
+	};
+	Mat4_t rXYZ = composeMat4Chain(3, rotations);
 
 	int tick;
 	for(tick = 0; tick < 207; tick++){
 		clearScreen();
-		multiplyMatrices(4, rX, rY, rZ, pts);
+		applyMat4(&rXYZ, pts);
 		drawMatrix(pts);
 		renderScreen();
+		resetArena(&g_frameArena);
 		// usleep(1e6 / 60);
 	}
 
-	freeMatrices(4, rX, rY, rZ, pts);
+	freeMatrix(pts);
+	stopRenderThreads();
 	renderScreen();
 	usleep(4e6);
 	quitScreen();
 }
 
 static void argumentHandler(int argc, char * argv[]){
+	while(1 < argc){
+		if(strcmp(FAST_CMD, argv[1]) == 0){
+			g_fastMath = 1;
+			argc--;
+			argv++;
+		}
+
+		else if(strcmp(EDGE_CMD, argv[1]) == 0){
+			g_rasterizer = RASTERIZER_EDGE;
+			argc--;
+			argv++;
+		}
+
+		else if(strcmp(THREADS_CMD, argv[1]) == 0){
+			if(argc < 3 || (g_renderThreads = atoi(argv[2])) < 1)
+				FATAL("--threads flag requires a positive argument.");
+			argc -= 2;
+			argv += 2;
+		}
+
+		else
+			break;
+	}
+
 	if(1 < argc){
 		if(strcmp(TEST_CMD, argv[1]) == 0)
 			exit(unitTests());
 
+		else if(strcmp(BENCH_CMD, argv[1]) == 0)
+			exit(benchmarks());
+
 		else if(strcmp(SCRIPT_CMD, argv[1]) == 0){
 			if(argc == 3)
 				readMDLFile(argv[2]);
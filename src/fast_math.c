@@ -0,0 +1,75 @@
+#include <stdint.h>
+#include <string.h>
+#include <tgmath.h>
+
+#include "src/fast_math.h"
+
+#ifdef FAST_MATH
+int g_fastMath = 1;
+#else
+int g_fastMath = 0;
+#endif
+
+// The sines of FAST_MATH_TABLE_SIZE evenly spaced angles in one turn, with
+// the first repeated at the end, so that interpolation never wraps.
+static double g_sineTable[FAST_MATH_TABLE_SIZE + 1];
+
+// Whether ::g_sineTable has been filled.
+static int g_sineTableReady;
+
+/*
+ * @brief Fill ::g_sineTable.
+ */
+static void fillSineTable(void);
+
+double fastSin(double radians){
+	if(!g_sineTableReady)
+		fillSineTable();
+
+	double position = radians * (FAST_MATH_TABLE_SIZE / (2 * M_PI));
+	double whole = floor(position), fraction = position - whole;
+	int index = (long)whole & (FAST_MATH_TABLE_SIZE - 1);
+	return g_sineTable[index] +
+		(g_sineTable[index + 1] - g_sineTable[index]) * fraction;
+}
+
+double fastCos(double radians){
+	return fastSin(radians + M_PI / 2);
+}
+
+double fastTan(double radians){
+	return fastSin(radians) / fastCos(radians);
+}
+
+double fastInvSqrt(double value){
+	// halving a float's bits, as an integer, roughly halves its exponent
+	float estimate = value;
+	uint32_t bits;
+	memcpy(&bits, &estimate, sizeof(bits));
+	bits = 0x5F3759DF - (bits >> 1);
+	memcpy(&estimate, &bits, sizeof(bits));
+
+	double inverse = estimate;
+	inverse *= 1.5 - 0.5 * value * inverse * inverse;
+	inverse *= 1.5 - 0.5 * value * inverse * inverse;
+	inverse *= 1.5 - 0.5 * value * inverse * inverse;
+	return inverse;
+}
+
+double powInt(double base, unsigned int exponent){
+	double result = 1;
+	while(exponent){
+		if(exponent & 1)
+			result *= base;
+		base *= base;
+		exponent >>= 1;
+	}
+	return result;
+}
+
+static void fillSineTable(void){
+	int entry;
+	for(entry = 0; entry <= FAST_MATH_TABLE_SIZE; entry++)
+		g_sineTable[entry] = sin(2 * M_PI * entry / FAST_MATH_TABLE_SIZE);
+	g_sineTableReady = 1;
+}
@@ -0,0 +1,321 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tgmath.h>
+
+#include "src/globals.h"
+#include "src/graphics/camera.h"
+#include "src/graphics/tiles.h"
+
+// A vertex of a triangle being clipped to the near plane.
+typedef struct {
+	Point_t pos[4]; // The vertex's eye-space position, then its projection.
+	RGB_t color[3]; // The vertex's color.
+} ViewVertex_t;
+
+Camera_t g_camera = {
+	.perspective = 0,
+	.view = {
+		.cols = {
+			{1, 0, 0, 0},
+			{0, 1, 0, 0},
+			{0, 0, 1, 0},
+			{0, 0, 0, 1}
+		}
+	}
+};
+
+extern int g_screenWidth, g_screenHeight;
+
+/*
+ * @brief Return the largest factor by which a transformation may scale a
+ *      length.
+ *
+ * That's the largest singular value of the transformation's upper-left 3x3,
+ * bounded from above by the square root of the largest absolute row sum of
+ * its Gram matrix; the bound is exact for rotations and uniform scalings.
+ *
+ * @param transform The transformation.
+ */
+static double maxScale(const Mat4_t *transform);
+
+/*
+ * @brief Carry a point into a camera's eye space.
+ *
+ * @param camera The camera.
+ * @param point The point, in world coordinates.
+ * @param eye Set to the point's eye-space coordinates.
+ */
+static void viewPoint(const Camera_t *camera, Point_t *point, Point_t *eye);
+
+/*
+ * @brief Project a point beyond a camera's near plane onto the screen.
+ *
+ * @param camera The camera.
+ * @param eye The point, in eye space.
+ * @param projected Set to the projected point; may be @p eye.
+ */
+static void projectEyePoint(const Camera_t *camera, Point_t *eye,
+	Point_t *projected);
+
+/*
+ * @brief Interpolate between two ::ViewVertex_t.
+ *
+ * @param v1 The vertex at @p t = 0.
+ * @param v2 The vertex at @p t = 1.
+ * @param t The parameter of the interpolated vertex.
+ * @param vertex Set to the interpolated vertex.
+ */
+static void interpolateVertex(const ViewVertex_t *v1, const ViewVertex_t *v2,
+	Point_t t, ViewVertex_t *vertex);
+
+Camera_t orthographicCamera(void){
+	return (Camera_t){
+		.perspective = 0,
+		.view = identityMat4(),
+		.focal = 0
+	};
+}
+
+Camera_t perspectiveCamera(Point_t *eye, Point_t *aim, double focal){
+	// the basis is built in double precision, and only then narrowed into the
+	// view, so that axes along the world's are exactly unit even in
+	// single-precision builds, whose divisions -Ofast may approximate
+	double zAxis[3] = {
+		eye[X] - aim[X],
+		eye[Y] - aim[Y],
+		eye[Z] - aim[Z]
+	};
+	double distance = sqrt(zAxis[X] * zAxis[X] + zAxis[Y] * zAxis[Y] +
+		zAxis[Z] * zAxis[Z]);
+	if(distance == 0)
+		FATAL("The camera's eye and aim must be distinct points.");
+	else if(focal < 0)
+		FATAL("The focal length cannot be negative.");
+
+	int axis;
+	for(axis = X; axis <= Z; axis++)
+		zAxis[axis] /= distance;
+
+	// the x axis is perpendicular to the y axis, unless the camera looks
+	// straight along it, in which case it's the world's
+	double xAxis[3] = {zAxis[Z], 0, -zAxis[X]};
+	double length = sqrt(xAxis[X] * xAxis[X] + xAxis[Z] * xAxis[Z]);
+	if(length == 0){
+		xAxis[X] = 1;
+		length = 1;
+	}
+	for(axis = X; axis <= Z; axis++)
+		xAxis[axis] /= length;
+
+	double yAxis[3] = {
+		zAxis[Y] * xAxis[Z] - zAxis[Z] * xAxis[Y],
+		zAxis[Z] * xAxis[X] - zAxis[X] * xAxis[Z],
+		zAxis[X] * xAxis[Y] - zAxis[Y] * xAxis[X]
+	};
+
+	Camera_t camera = {
+		.perspective = 1,
+		.view = identityMat4(),
+		.focal = (focal == 0)?distance:focal
+	};
+	double *axes[3] = {xAxis, yAxis, zAxis};
+	int row;
+	for(row = X; row <= Z; row++){
+		for(axis = X; axis <= Z; axis++)
+			MAT4(&camera.view, row, axis) = axes[row][axis];
+		MAT4(&camera.view, row, W) = -(axes[row][X] * eye[X] +
+			axes[row][Y] * eye[Y] + axes[row][Z] * eye[Z]);
+	}
+	return camera;
+}
+
+int sphereInView(const Camera_t *camera, Point_t *center, double radius,
+	const Mat4_t *transform, Mat4_t *lod){
+	Point_t world[4];
+	int row;
+	for(row = X; row <= W; row++)
+		world[row] = MAT4(transform, row, X) * center[X] +
+			MAT4(transform, row, Y) * center[Y] +
+			MAT4(transform, row, Z) * center[Z] +
+			MAT4(transform, row, W) * center[W];
+	double bound = radius * maxScale(transform);
+
+	// a pixel is at most half the screen, rounded up, from its center
+	double halfWidth = g_screenWidth / 2 + 1,
+		halfHeight = g_screenHeight / 2 + 1;
+
+	if(!camera->perspective){
+		if(fabs(world[X]) - bound > halfWidth ||
+			fabs(world[Y]) - bound > halfHeight)
+			return 0;
+		*lod = *transform;
+		return 1;
+	}
+
+	Point_t eye[4];
+	viewPoint(camera, world, eye);
+	double depth = -eye[Z];
+	if(depth + bound < CAMERA_NEAR_PLANE)
+		return 0;
+
+	// each side of the frustum is a plane through the eye and an edge of the
+	// screen, placed at the focal length
+	double focal = camera->focal;
+	if(focal * fabs(eye[X]) - halfWidth * depth >
+		bound * sqrt(focal * focal + halfWidth * halfWidth) ||
+		focal * fabs(eye[Y]) - halfHeight * depth >
+		bound * sqrt(focal * focal + halfHeight * halfHeight))
+		return 0;
+
+	// the nearest point of the sphere is magnified the most
+	double scale = focal / fmax(depth - bound, CAMERA_NEAR_PLANE);
+	Mat4_t chain[3] = {
+		*transform,
+		camera->view,
+		scaleMat4(POINT(scale, scale, 1))
+	};
+	*lod = composeMat4Chain(3, chain);
+	return 1;
+}
+
+int projectPoint(const Camera_t *camera, Point_t *point, Point_t *projected){
+	viewPoint(camera, point, projected);
+	if(-projected[Z] < CAMERA_NEAR_PLANE){
+		projected[W] = 0;
+		return 0;
+	}
+
+	projectEyePoint(camera, projected, projected);
+	return 1;
+}
+
+void projectEdges(const Camera_t *camera, Matrix_t *edges){
+	if(!camera->perspective)
+		return;
+
+	int point, kept = 0;
+	for(point = 0; point + 1 < edges->numPoints; point += 2){
+		ViewVertex_t p1 = {.color = {0}}, p2 = {.color = {0}};
+		viewPoint(camera, edges->points[point], p1.pos);
+		viewPoint(camera, edges->points[point + 1], p2.pos);
+
+		Point_t d1 = -p1.pos[Z] - CAMERA_NEAR_PLANE,
+			d2 = -p2.pos[Z] - CAMERA_NEAR_PLANE;
+		if(d1 < 0 && d2 < 0)
+			continue;
+
+		if(d1 < 0)
+			interpolateVertex(&p1, &p2, d1 / (d1 - d2), &p1);
+		else if(d2 < 0)
+			interpolateVertex(&p1, &p2, d1 / (d1 - d2), &p2);
+
+		projectEyePoint(camera, p1.pos, edges->points[kept++]);
+		projectEyePoint(camera, p2.pos, edges->points[kept++]);
+	}
+	edges->numPoints = kept;
+}
+
+void submitViewTriangle(const Camera_t *camera, Light_t *l1, Light_t *l2,
+	Light_t *l3){
+	Light_t *lights[3] = {l1, l2, l3};
+	ViewVertex_t triangle[3];
+	Point_t distance[3];
+	int vertex, beyond = 0;
+	for(vertex = 0; vertex < 3; vertex++){
+		viewPoint(camera, lights[vertex]->pos, triangle[vertex].pos);
+		memcpy(triangle[vertex].color, lights[vertex]->color,
+			sizeof(triangle[vertex].color));
+		distance[vertex] = -triangle[vertex].pos[Z] - CAMERA_NEAR_PLANE;
+		beyond += distance[vertex] >= 0;
+	}
+	if(beyond == 0)
+		return;
+
+	// clipping a triangle to one plane leaves at most a quadrilateral
+	ViewVertex_t clipped[4];
+	int numClipped = 0;
+	for(vertex = 0; vertex < 3; vertex++){
+		int next = (vertex + 1) % 3;
+		if(distance[vertex] >= 0)
+			clipped[numClipped++] = triangle[vertex];
+		if((distance[vertex] >= 0) != (distance[next] >= 0))
+			interpolateVertex(&triangle[vertex], &triangle[next],
+				distance[vertex] / (distance[vertex] - distance[next]),
+				&clipped[numClipped++]);
+	}
+
+	for(vertex = 0; vertex < numClipped; vertex++)
+		projectEyePoint(camera, clipped[vertex].pos, clipped[vertex].pos);
+
+	for(vertex = 1; vertex + 1 < numClipped; vertex++){
+		ViewVertex_t *v1 = &clipped[0], *v2 = &clipped[vertex],
+			*v3 = &clipped[vertex + 1];
+		if(backfaceCull(v1->pos, v2->pos, v3->pos))
+			submitTriangle(
+				&(Light_t){
+					.color = v1->color,
+					.pos = v1->pos
+				},
+				&(Light_t){
+					.color = v2->color,
+					.pos = v2->pos
+				},
+				&(Light_t){
+					.color = v3->color,
+					.pos = v3->pos
+				}
+			);
+	}
+}
+
+static double maxScale(const Mat4_t *transform){
+	double largest = 0;
+	int row, col, axis;
+	for(row = X; row <= Z; row++){
+		double sum = 0;
+		for(col = X; col <= Z; col++){
+			Point_t gram = 0;
+			for(axis = X; axis <= Z; axis++)
+				gram += MAT4(transform, axis, row) * MAT4(transform, axis, col);
+			sum += fabs(gram);
+		}
+		largest = fmax(largest, sum);
+	}
+	return sqrt(largest);
+}
+
+static void viewPoint(const Camera_t *camera, Point_t *point, Point_t *eye){
+	const Mat4_t *view = &camera->view;
+	Point_t x = point[X], y = point[Y], z = point[Z], w = point[W];
+	int row;
+	for(row = X; row <= W; row++)
+		eye[row] = MAT4(view, row, X) * x + MAT4(view, row, Y) * y +
+			MAT4(view, row, Z) * z + MAT4(view, row, W) * w;
+}
+
+static void projectEyePoint(const Camera_t *camera, Point_t *eye,
+	Point_t *projected){
+	// scaled in double precision, and then narrowed, so that a point at the
+	// focal plane keeps its coordinates exactly
+	double scale = camera->focal / -(double)eye[Z];
+	projected[X] = eye[X] * scale;
+	projected[Y] = eye[Y] * scale;
+	// the reciprocal of the depth varies linearly across the screen, so it
+	// interpolates exactly; shifted by the focal length, it matches the
+	// orthographic depth at the focal plane, in value and slope
+	projected[Z] = camera->focal * (scale - 1);
+	projected[W] = 1;
+}
+
+static void interpolateVertex(const ViewVertex_t *v1, const ViewVertex_t *v2,
+	Point_t t, ViewVertex_t *vertex){
+	ViewVertex_t mix;
+	int coord;
+	for(coord = X; coord <= W; coord++)
+		mix.pos[coord] = v1->pos[coord] + (v2->pos[coord] - v1->pos[coord]) * t;
+	for(coord = R; coord <= B; coord++)
+		mix.color[coord] = v1->color[coord] +
+			(v2->color[coord] - v1->color[coord]) * t + 0.5;
+	*vertex = mix;
+}
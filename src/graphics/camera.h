@@ -0,0 +1,106 @@
+/*!
+ *  @file
+ *  @brief The view and projection stage that follows the transform stack.
+ *
+ *  Without a camera, the scene is projected orthographically: a point's x and
+ *  y are its offset, in pixels, from the center of the screen, and its z is
+ *  its depth. A perspective ::Camera_t first carries points into eye space,
+ *  with the eye at the origin looking down the negative z axis, and then
+ *  divides their x and y by their distance from the eye, so that a point at
+ *  the focal length is drawn at its orthographic size.
+ *
+ *  Primitives are culled against the view frustum by their bounding spheres
+ *  before they're tessellated, and triangles that cross the near plane are
+ *  clipped to it before they're projected, so nothing behind the eye is ever
+ *  lit or rasterized.
+ */
+
+#pragma once
+
+#include "src/graphics/graphics.h"
+#include "src/graphics/transform.h"
+
+// The distance from the eye to the near plane, in the scene's units.
+#define CAMERA_NEAR_PLANE 1
+
+//! The projection applied to everything drawn after the transform stack.
+typedef struct {
+	int perspective; //! Whether to project in perspective; else orthographic.
+	Mat4_t view; //! Carries world coordinates into eye space.
+	double focal; //! The distance from the eye at which a unit is a pixel.
+} Camera_t;
+
+//! The camera that ::drawMesh() and ::drawTriangle() project through.
+extern Camera_t g_camera;
+
+/*!
+ *  @brief Return a camera that projects orthographically, as if there were
+ *      none.
+ */
+Camera_t orthographicCamera(void);
+
+/*!
+ *  @brief Return a perspective camera.
+ *
+ *  The camera's up is the direction of the y axis, as seen from @p eye.
+ *
+ *  @param eye The position of the eye.
+ *  @param aim The point at the center of the view; distinct from @p eye.
+ *  @param focal The focal length; if 0, the distance from @p eye to @p aim,
+ *      so that the plane through @p aim is drawn at its orthographic size.
+ */
+Camera_t perspectiveCamera(Point_t *eye, Point_t *aim, double focal);
+
+/*!
+ *  @brief Test a transformed bounding sphere against a camera's view frustum.
+ *
+ *  The sphere is conservatively bounded under @p transform by the largest
+ *  scaling it applies, so it's reported visible if any of it may be.
+ *
+ *  @param camera The camera.
+ *  @param center The center of the sphere, before @p transform.
+ *  @param radius The radius of the sphere, before @p transform.
+ *  @param transform The transformation the sphere will be drawn under.
+ *  @param lod If the sphere is visible, set to a transformation that scales
+ *      the sphere's x and y at least as much as its projection does, for
+ *      ::circleSegments(); @p transform itself, for an orthographic camera.
+ *
+ *  @return 1 if any of the sphere may be in view; 0 otherwise.
+ */
+int sphereInView(const Camera_t *camera, Point_t *center, double radius,
+	const Mat4_t *transform, Mat4_t *lod);
+
+/*!
+ *  @brief Project a point through a perspective camera.
+ *
+ *  @param camera The camera.
+ *  @param point The point, in world coordinates.
+ *  @param projected Set to the projected point if it's beyond the near plane;
+ *      to its eye-space coordinates, with a w of 0, otherwise.
+ *
+ *  @return 1 if @p point is beyond the near plane; 0 otherwise.
+ */
+int projectPoint(const Camera_t *camera, Point_t *point, Point_t *projected);
+
+/*!
+ *  @brief Project the edges of a ::Matrix_t through a camera (in place).
+ *
+ *  Edges are clipped to the near plane first, and those entirely on the
+ *  eye's side of it are removed.
+ *
+ *  @param camera The camera; nothing is done if it's orthographic.
+ *  @param edges The edges, as pairs of points in world coordinates.
+ */
+void projectEdges(const Camera_t *camera, Matrix_t *edges);
+
+/*!
+ *  @brief Clip a lit triangle to a perspective camera's near plane, project
+ *      it, and pass the pieces that face the camera to ::submitTriangle().
+ *
+ *  @param camera The camera.
+ *  @param l1 The first vertex of the triangle, in world coordinates.
+ *  @param l2 The second vertex of the triangle, in world coordinates.
+ *  @param l3 The third vertex of the triangle, in world coordinates.
+ */
+void submitViewTriangle(const Camera_t *camera, Light_t *l1, Light_t *l2,
+	Light_t *l3);
@@ -0,0 +1,350 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <tgmath.h>
+
+#include "src/arena.h"
+#include "src/globals.h"
+#include "src/graphics/cull.h"
+#include "src/graphics/graphics.h"
+#include "src/graphics/screen.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define X86_KERNELS
+#endif
+
+// A batch of triangles' screen positions, in structure-of-arrays layout, and
+// the bounds they're tested against.
+typedef struct {
+	Point_t *x[3]; // The x-coordinates of every triangle's three corners.
+	Point_t *y[3]; // The y-coordinates of every triangle's three corners.
+	Point_t halfWidth; // The offset of the screen's columns from x = 0.
+	Point_t halfHeight; // The offset of the screen's rows from y = 0.
+	Point_t left, right; // One column beyond the clip rectangle's sides.
+	Point_t top, bottom; // One row beyond the clip rectangle's top and bottom.
+	int rasterizer; // The ::g_rasterizer the triangles will be drawn with.
+} CullBatch_t;
+
+// A cull kernel: sets each of @p numTriangles triangles' reason for being
+// culled, or ::CULL_REASONS if it survives.
+typedef void (*CullKernel_t)(const CullBatch_t *batch, int first,
+	int numTriangles, unsigned char *reasons);
+
+/*
+ * @brief Cull triangles one at a time.
+ *
+ * The reference implementation: the tests are those of ::backfaceCull(),
+ * ::triangleBounds() and ::clipRect(), and of the rasterizers' sampling, and
+ * every other kernel evaluates them with the same arithmetic.
+ *
+ * @param batch The triangles.
+ * @param first The index of the first triangle to cull.
+ * @param numTriangles The number of triangles to cull.
+ * @param reasons Set to each triangle's ::CULL_BACKFACE (etc.), or to
+ *      ::CULL_REASONS if it survives; indexed like @p batch.
+ */
+static void scalarCullKernel(const CullBatch_t *batch, int first,
+	int numTriangles, unsigned char *reasons);
+
+#ifdef X86_KERNELS
+/*
+ * @brief Cull triangles with 128-bit SSE2 vectors: two triangles per vector,
+ *      or four in single precision.
+ *
+ * @params See ::scalarCullKernel().
+ */
+static void sse2CullKernel(const CullBatch_t *batch, int first,
+	int numTriangles, unsigned char *reasons);
+#endif
+
+/*
+ * @brief Return the kernel for a ::CULL_KERNEL_* identifier.
+ *
+ * @param kernel The identifier.
+ *
+ * @return A pointer to the kernel function, or NULL if the current CPU (or
+ *      build) doesn't support it.
+ */
+static CullKernel_t findCullKernel(int kernel);
+
+/*
+ * @brief Clamp a screen coordinate to the edge rasterizer's guard band.
+ *
+ * Coordinates within the band are unchanged, and the rest stay beyond the
+ * screen, so they can be rounded to fixed point without overflowing.
+ *
+ * @param coord The coordinate.
+ */
+static inline Point_t clampCoordinate(Point_t coord);
+
+CullStats_t g_cullStats;
+
+// The kernel used by ::cullTriangles(), or NULL before one has been selected.
+static CullKernel_t g_cullKernel = NULL;
+
+extern int g_screenWidth, g_screenHeight;
+
+int cullTriangles(Point_t (*points)[4], const int *indices, int numTriangles,
+	int *survivors){
+	if(g_cullKernel == NULL)
+		setCullKernel(CULL_KERNEL_AUTO);
+
+	CullBatch_t batch = {
+		.halfWidth = g_screenWidth / 2,
+		.halfHeight = g_screenHeight / 2,
+		.left = ((g_clipRect.minX > 0)?g_clipRect.minX:0) - 1,
+		.right = ((g_clipRect.maxX < g_screenWidth - 1)?
+			g_clipRect.maxX:g_screenWidth - 1) + 1,
+		.top = ((g_clipRect.minY > 0)?g_clipRect.minY:0) - 1,
+		.bottom = ((g_clipRect.maxY < g_screenHeight - 1)?
+			g_clipRect.maxY:g_screenHeight - 1) + 1,
+		.rasterizer = g_rasterizer
+	};
+
+	// gather the corners into one array per coordinate
+	int corner, triangle;
+	for(corner = 0; corner < 3; corner++){
+		batch.x[corner] = arenaAlloc(&g_frameArena,
+			numTriangles * sizeof(Point_t));
+		batch.y[corner] = arenaAlloc(&g_frameArena,
+			numTriangles * sizeof(Point_t));
+	}
+	unsigned char *reasons = arenaAlloc(&g_frameArena, numTriangles),
+		*clipped = arenaAlloc(&g_frameArena, numTriangles);
+	for(triangle = 0; triangle < numTriangles; triangle++){
+		clipped[triangle] = 0;
+		for(corner = 0; corner < 3; corner++){
+			int vertex = (indices == NULL)?3 * triangle + corner:
+				indices[3 * triangle + corner];
+			batch.x[corner][triangle] = points[vertex][X];
+			batch.y[corner][triangle] = points[vertex][Y];
+			clipped[triangle] |= points[vertex][W] == 0;
+		}
+	}
+
+	g_cullKernel(&batch, 0, numTriangles, reasons);
+
+	int numSurvivors = 0;
+	for(triangle = 0; triangle < numTriangles; triangle++){
+		if(clipped[triangle])
+			survivors[numSurvivors++] = triangle;
+		else {
+			g_cullStats.triangles++;
+			if(reasons[triangle] == CULL_REASONS)
+				survivors[numSurvivors++] = triangle;
+			else
+				g_cullStats.culled[reasons[triangle]]++;
+		}
+	}
+	return numSurvivors;
+}
+
+int setCullKernel(int kernel){
+	if(kernel == CULL_KERNEL_AUTO){
+		int fastest;
+		for(fastest = CULL_KERNEL_SSE2; fastest > CULL_KERNEL_SCALAR;
+			fastest--)
+			if(findCullKernel(fastest) != NULL)
+				break;
+		kernel = fastest;
+	}
+
+	CullKernel_t found = findCullKernel(kernel);
+	if(found == NULL)
+		return 0;
+
+	g_cullKernel = found;
+	return 1;
+}
+
+static void scalarCullKernel(const CullBatch_t *batch, int first,
+	int numTriangles, unsigned char *reasons){
+	long long half = 1 << (SUBPIXEL_BITS - 1),
+		ceilBias = (1 << SUBPIXEL_BITS) - 1;
+
+	int triangle;
+	for(triangle = first; triangle < first + numTriangles; triangle++){
+		Point_t x1 = batch->x[0][triangle], y1 = batch->y[0][triangle],
+			x2 = batch->x[1][triangle], y2 = batch->y[1][triangle],
+			x3 = batch->x[2][triangle], y3 = batch->y[2][triangle];
+
+		Point_t area = (x2 - x1) * (y3 - y1) - (y2 - y1) * (x3 - x1);
+		if(area <= -1){
+			reasons[triangle] = CULL_BACKFACE;
+			continue;
+		}
+		else if(!(area >= 1)){
+			reasons[triangle] = CULL_DEGENERATE;
+			continue;
+		}
+
+		Point_t minX = fmin(x1, fmin(x2, x3)), maxX = fmax(x1, fmax(x2, x3)),
+			minY = fmin(y1, fmin(y2, y3)), maxY = fmax(y1, fmax(y2, y3));
+		if(minX + batch->halfWidth - 1 >= batch->right ||
+			maxX + batch->halfWidth + 1 <= batch->left ||
+			minY + batch->halfHeight - 1 >= batch->bottom ||
+			maxY + batch->halfHeight + 1 <= batch->top){
+			reasons[triangle] = CULL_OFFSCREEN;
+			continue;
+		}
+
+		int subpixel;
+		if(batch->rasterizer == RASTERIZER_EDGE){
+			// the edge rasterizer samples pixel centers, in fixed point
+			long long left = llrint(clampCoordinate(minX + batch->halfWidth) *
+					(1 << SUBPIXEL_BITS)),
+				right = llrint(clampCoordinate(maxX + batch->halfWidth) *
+					(1 << SUBPIXEL_BITS)),
+				top = llrint(clampCoordinate(minY + batch->halfHeight) *
+					(1 << SUBPIXEL_BITS)),
+				bottom = llrint(clampCoordinate(maxY + batch->halfHeight) *
+					(1 << SUBPIXEL_BITS));
+			subpixel = (left - half + ceilBias) >> SUBPIXEL_BITS >
+					(right - half) >> SUBPIXEL_BITS ||
+				(top - half + ceilBias) >> SUBPIXEL_BITS >
+					(bottom - half) >> SUBPIXEL_BITS;
+		}
+		else
+			// the scanline rasterizer walks the rows between its vertices'
+			// truncated y-coordinates
+			subpixel = (int)clampCoordinate(minY) ==
+				(int)clampCoordinate(maxY);
+
+		reasons[triangle] = subpixel?CULL_SUBPIXEL:CULL_REASONS;
+	}
+}
+
+#ifdef X86_KERNELS
+#ifdef SINGLE_PRECISION
+typedef __m128 CullVector_t;
+#define CULL_LANES 4
+#define VEC_LOAD _mm_loadu_ps
+#define VEC_SET1 _mm_set1_ps
+#define VEC_ADD _mm_add_ps
+#define VEC_SUB _mm_sub_ps
+#define VEC_MUL _mm_mul_ps
+#define VEC_MIN _mm_min_ps
+#define VEC_MAX _mm_max_ps
+#define VEC_OR _mm_or_ps
+#define VEC_GE _mm_cmpge_ps
+#define VEC_LE _mm_cmple_ps
+#define VEC_MASK _mm_movemask_ps
+#define VEC_ROUND _mm_cvtps_epi32
+#define VEC_TRUNCATE _mm_cvttps_epi32
+#else
+typedef __m128d CullVector_t;
+#define CULL_LANES 2
+#define VEC_LOAD _mm_loadu_pd
+#define VEC_SET1 _mm_set1_pd
+#define VEC_ADD _mm_add_pd
+#define VEC_SUB _mm_sub_pd
+#define VEC_MUL _mm_mul_pd
+#define VEC_MIN _mm_min_pd
+#define VEC_MAX _mm_max_pd
+#define VEC_OR _mm_or_pd
+#define VEC_GE _mm_cmpge_pd
+#define VEC_LE _mm_cmple_pd
+#define VEC_MASK _mm_movemask_pd
+#define VEC_ROUND _mm_cvtpd_epi32
+#define VEC_TRUNCATE _mm_cvttpd_epi32
+#endif
+
+// The lanes of an integer comparison, as a bitmask; the conversions from
+// doubles fill only the low two.
+#define INT_MASK(vector) \
+	(_mm_movemask_ps(_mm_castsi128_ps(vector)) & ((1 << CULL_LANES) - 1))
+
+static void sse2CullKernel(const CullBatch_t *batch, int first,
+	int numTriangles, unsigned char *reasons){
+	CullVector_t one = VEC_SET1(1), minusOne = VEC_SET1(-1),
+		halfWidth = VEC_SET1(batch->halfWidth),
+		halfHeight = VEC_SET1(batch->halfHeight),
+		left = VEC_SET1(batch->left), right = VEC_SET1(batch->right),
+		top = VEC_SET1(batch->top), bottom = VEC_SET1(batch->bottom),
+		minCoord = VEC_SET1(-RASTER_MAX_COORDINATE),
+		maxCoord = VEC_SET1(RASTER_MAX_COORDINATE),
+		subpixels = VEC_SET1(1 << SUBPIXEL_BITS);
+	__m128i minBias = _mm_set1_epi32((1 << (SUBPIXEL_BITS - 1)) - 1),
+		maxBias = _mm_set1_epi32(-(1 << (SUBPIXEL_BITS - 1)));
+
+	int triangle = first, end = first + numTriangles;
+	for(; triangle + CULL_LANES <= end; triangle += CULL_LANES){
+		CullVector_t x1 = VEC_LOAD(&batch->x[0][triangle]),
+			y1 = VEC_LOAD(&batch->y[0][triangle]),
+			x2 = VEC_LOAD(&batch->x[1][triangle]),
+			y2 = VEC_LOAD(&batch->y[1][triangle]),
+			x3 = VEC_LOAD(&batch->x[2][triangle]),
+			y3 = VEC_LOAD(&batch->y[2][triangle]);
+
+		CullVector_t area = VEC_SUB(
+			VEC_MUL(VEC_SUB(x2, x1), VEC_SUB(y3, y1)),
+			VEC_MUL(VEC_SUB(y2, y1), VEC_SUB(x3, x1)));
+		int backface = VEC_MASK(VEC_LE(area, minusOne)),
+			front = VEC_MASK(VEC_GE(area, one));
+
+		CullVector_t minX = VEC_MIN(x1, VEC_MIN(x2, x3)),
+			maxX = VEC_MAX(x1, VEC_MAX(x2, x3)),
+			minY = VEC_MIN(y1, VEC_MIN(y2, y3)),
+			maxY = VEC_MAX(y1, VEC_MAX(y2, y3));
+		int offscreen = VEC_MASK(VEC_OR(
+			VEC_OR(VEC_GE(VEC_SUB(VEC_ADD(minX, halfWidth), one), right),
+				VEC_LE(VEC_ADD(VEC_ADD(maxX, halfWidth), one), left)),
+			VEC_OR(VEC_GE(VEC_SUB(VEC_ADD(minY, halfHeight), one), bottom),
+				VEC_LE(VEC_ADD(VEC_ADD(maxY, halfHeight), one), top))));
+
+		int subpixel;
+		if(batch->rasterizer == RASTERIZER_EDGE){
+			__m128i leftPixel = _mm_srai_epi32(_mm_add_epi32(VEC_ROUND(
+					VEC_MUL(VEC_MIN(VEC_MAX(VEC_ADD(minX, halfWidth),
+					minCoord), maxCoord), subpixels)), minBias), SUBPIXEL_BITS),
+				rightPixel = _mm_srai_epi32(_mm_add_epi32(VEC_ROUND(
+					VEC_MUL(VEC_MIN(VEC_MAX(VEC_ADD(maxX, halfWidth),
+					minCoord), maxCoord), subpixels)), maxBias), SUBPIXEL_BITS),
+				topPixel = _mm_srai_epi32(_mm_add_epi32(VEC_ROUND(
+					VEC_MUL(VEC_MIN(VEC_MAX(VEC_ADD(minY, halfHeight),
+					minCoord), maxCoord), subpixels)), minBias), SUBPIXEL_BITS),
+				bottomPixel = _mm_srai_epi32(_mm_add_epi32(VEC_ROUND(
+					VEC_MUL(VEC_MIN(VEC_MAX(VEC_ADD(maxY, halfHeight),
+					minCoord), maxCoord), subpixels)), maxBias), SUBPIXEL_BITS);
+			subpixel = INT_MASK(_mm_or_si128(
+				_mm_cmpgt_epi32(leftPixel, rightPixel),
+				_mm_cmpgt_epi32(topPixel, bottomPixel)));
+		}
+		else
+			subpixel = INT_MASK(_mm_cmpeq_epi32(
+				VEC_TRUNCATE(VEC_MIN(VEC_MAX(minY, minCoord), maxCoord)),
+				VEC_TRUNCATE(VEC_MIN(VEC_MAX(maxY, minCoord), maxCoord))));
+
+		int lane;
+		for(lane = 0; lane < CULL_LANES; lane++){
+			int bit = 1 << lane;
+			reasons[triangle + lane] = (backface & bit)?CULL_BACKFACE:
+				!(front & bit)?CULL_DEGENERATE:
+				(offscreen & bit)?CULL_OFFSCREEN:
+				(subpixel & bit)?CULL_SUBPIXEL:CULL_REASONS;
+		}
+	}
+
+	if(triangle < end)
+		scalarCullKernel(batch, triangle, end - triangle, reasons);
+}
+#endif
+
+static CullKernel_t findCullKernel(int kernel){
+	switch(kernel){
+		case CULL_KERNEL_SCALAR:
+			return &scalarCullKernel;
+
+#ifdef X86_KERNELS
+		case CULL_KERNEL_SSE2:
+			return __builtin_cpu_supports("sse2")?&sse2CullKernel:NULL;
+#endif
+
+		default:
+			return NULL;
+	}
+}
+
+static inline Point_t clampCoordinate(Point_t coord){
+	return fmin(fmax(coord, -RASTER_MAX_COORDINATE), RASTER_MAX_COORDINATE);
+}
@@ -0,0 +1,72 @@
+/*!
+ *  @file
+ *  @brief A culling stage that runs over a batch of triangles before any of
+ *      them is shaded.
+ *
+ *  ::drawMatrix() and ::drawMesh() pass every triangle through
+ *  ::cullTriangles() first, and light only the survivors. A triangle is
+ *  culled if it faces away from the viewer, if its area is within rounding of
+ *  zero, if its bounding box misses the screen, or if it covers none of the
+ *  active rasterizer's sample points; in every case it would have drawn
+ *  nothing, so culling doesn't change the output. The tests run over the
+ *  batch in a structure-of-arrays layout, several triangles per vector where
+ *  the CPU allows.
+ */
+
+#pragma once
+
+#include "src/graphics/matrix.h"
+
+// Identifiers for the kernels ::cullTriangles() can use; see ::setCullKernel().
+#define CULL_KERNEL_AUTO -1 // The fastest kernel the CPU supports.
+#define CULL_KERNEL_SCALAR 0 // Plain C; always available.
+#define CULL_KERNEL_SSE2 1 // x86 SSE2.
+
+// The reasons a triangle is culled, in order of precedence; indices into
+// ::CullStats_t::culled.
+#define CULL_BACKFACE 0 // It faces away from the viewer.
+#define CULL_DEGENERATE 1 // Its signed area is within a pixel of zero.
+#define CULL_OFFSCREEN 2 // Its bounding box misses the screen.
+#define CULL_SUBPIXEL 3 // It falls between the rasterizer's sample points.
+#define CULL_REASONS 4 // The number of reasons.
+
+//! Counts of the triangles tested by ::cullTriangles().
+typedef struct {
+	long triangles; //! The triangles tested.
+	long culled[CULL_REASONS]; //! The triangles culled, per reason.
+} CullStats_t;
+
+//! What ::cullTriangles() has counted; reset it to start counting afresh.
+extern CullStats_t g_cullStats;
+
+/*!
+ *  @brief Cull a batch of triangles, and list the survivors.
+ *
+ *  Triangles with a vertex short of a perspective camera's near plane (with
+ *  a w of 0, as left by ::projectPoint()) can't be tested until they're
+ *  clipped, and always survive. The others are counted in ::g_cullStats.
+ *
+ *  @param points The vertices' positions on the screen.
+ *  @param indices Three offsets into @p points per triangle; NULL if the
+ *      triangles' vertices are consecutive, as in a ::Matrix_t.
+ *  @param numTriangles The number of triangles.
+ *  @param survivors Set to the indices of the triangles that survive, in
+ *      order; room for @p numTriangles of them.
+ *
+ *  @return The number of surviving triangles.
+ */
+int cullTriangles(Point_t (*points)[4], const int *indices, int numTriangles,
+	int *survivors);
+
+/*!
+ *  @brief Select the kernel used by ::cullTriangles().
+ *
+ *  All kernels evaluate the same tests with the same arithmetic, so they
+ *  cull the same triangles; they differ only in speed.
+ *
+ *  @param kernel One of the CULL_KERNEL_* identifiers.
+ *
+ *  @return 1 if the kernel was selected; 0 if the CPU or build doesn't
+ *      support it, in which case the current kernel is kept.
+ */
+int setCullKernel(int kernel);
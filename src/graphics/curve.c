@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <tgmath.h>
+
+#include "src/graphics/curve.h"
+#include "src/graphics/geometry.h"
+#include "src/graphics/graphics.h"
+#include "src/graphics/matrix.h"
+
+/*
+ * @brief Set a point to the midpoint of two others.
+ *
+ * @param mid (Point_t *) The point to set.
+ * @param p1 (Point_t *) The first point.
+ * @param p2 (Point_t *) The second point.
+ */
+#define MIDPOINT(mid, p1, p2) \
+	do {\
+		(mid)[X] = ((p1)[X] + (p2)[X]) / 2;\
+		(mid)[Y] = ((p1)[Y] + (p2)[Y]) / 2;\
+		(mid)[Z] = ((p1)[Z] + (p2)[Z]) / 2;\
+		(mid)[W] = 1;\
+	} while(0)
+
+/*
+ * @brief Return the number of segments a Bezier curve's polyline needs.
+ *
+ * By Wang's formula, a polyline through @a n evenly spaced parameters strays
+ * at most @f$\frac{3}{4} \frac{M}{n^2}@f$ from the curve, where @a M bounds
+ * the length of the control polygon's second differences; distances are
+ * measured in the screen's plane.
+ *
+ * @param ctrl The curve's four control points.
+ */
+static int curveSegments(Point_t ctrl[4][4]);
+
+/*
+ * @brief Add the polyline of a Bezier curve, after its first vertex, to a
+ *      ::Matrix_t.
+ *
+ * @param polyline The ::Matrix_t to add the vertices to.
+ * @param ctrl The curve's four control points.
+ * @param depth The number of times the curve has been split in half.
+ */
+static void flattenPiece(Matrix_t *polyline, Point_t ctrl[4][4], int depth);
+
+void flattenBezier(Matrix_t *polyline, Point_t *p1, Point_t *p2, Point_t *p3,
+	Point_t *p4){
+	Point_t ctrl[4][4] = {
+		{p1[X], p1[Y], p1[Z], 1},
+		{p2[X], p2[Y], p2[Z], 1},
+		{p3[X], p3[Y], p3[Z], 1},
+		{p4[X], p4[Y], p4[Z], 1}
+	};
+	addPoint(polyline, ctrl[0]);
+	flattenPiece(polyline, ctrl, 0);
+}
+
+void flattenHermite(Matrix_t *polyline, Point_t *p1, Point_t *p2, Point_t *p3,
+	Point_t *p4){
+	// a Hermite curve's tangents are three times the offsets of the inner
+	// control points of the equivalent Bezier curve
+	Point_t ctrl[4][4] = {
+		{p1[X], p1[Y], p1[Z], 1},
+		{
+			p1[X] + (p2[X] - p1[X]) / 3,
+			p1[Y] + (p2[Y] - p1[Y]) / 3,
+			p1[Z] + (p2[Z] - p1[Z]) / 3,
+			1
+		},
+		{
+			p3[X] - (p4[X] - p3[X]) / 3,
+			p3[Y] - (p4[Y] - p3[Y]) / 3,
+			p3[Z] - (p4[Z] - p3[Z]) / 3,
+			1
+		},
+		{p3[X], p3[Y], p3[Z], 1}
+	};
+	addPoint(polyline, ctrl[0]);
+	flattenPiece(polyline, ctrl, 0);
+}
+
+void drawPolyline(const Matrix_t *polyline, int color){
+	int point;
+	for(point = 1; point < polyline->numPoints; point++)
+		drawLine(polyline->points[point - 1], polyline->points[point], color);
+}
+
+static int curveSegments(Point_t ctrl[4][4]){
+	Point_t maxSquared = 0;
+	int point;
+	for(point = 0; point < 2; point++){
+		Point_t dx = ctrl[point][X] - 2 * ctrl[point + 1][X] +
+				ctrl[point + 2][X],
+			dy = ctrl[point][Y] - 2 * ctrl[point + 1][Y] + ctrl[point + 2][Y];
+		if(dx * dx + dy * dy > maxSquared)
+			maxSquared = dx * dx + dy * dy;
+	}
+
+	int segments = ceil(sqrt(0.75 * sqrt(maxSquared) / CURVE_TOLERANCE));
+	return (segments < 1)?1:segments;
+}
+
+static void flattenPiece(Matrix_t *polyline, Point_t ctrl[4][4], int depth){
+	int segments = curveSegments(ctrl);
+
+	if(segments > CURVE_SPLIT_SEGMENTS && depth < CURVE_MAX_DEPTH){
+		// split the curve at t = 0.5 with de Casteljau's algorithm
+		Point_t left[4][4], right[4][4], middle[4];
+		MIDPOINT(left[1], ctrl[0], ctrl[1]);
+		MIDPOINT(middle, ctrl[1], ctrl[2]);
+		MIDPOINT(right[2], ctrl[2], ctrl[3]);
+		MIDPOINT(left[2], left[1], middle);
+		MIDPOINT(right[1], middle, right[2]);
+		MIDPOINT(left[3], left[2], right[1]);
+
+		int coord;
+		for(coord = 0; coord < 4; coord++){
+			left[0][coord] = ctrl[0][coord];
+			right[0][coord] = left[3][coord];
+			right[3][coord] = ctrl[3][coord];
+		}
+
+		flattenPiece(polyline, left, depth + 1);
+		flattenPiece(polyline, right, depth + 1);
+		return;
+	}
+
+	// the curve's power-basis coefficients, a t^3 + b t^2 + c t + d, turned
+	// into forward differences for a step of 1 / segments
+	Point_t step = 1.0 / segments, step2 = step * step, step3 = step2 * step;
+	Point_t point[3], delta1[3], delta2[3], delta3[3];
+	int coord;
+	for(coord = 0; coord < 3; coord++){
+		Point_t a = ctrl[3][coord] - ctrl[0][coord] +
+				3 * (ctrl[1][coord] - ctrl[2][coord]),
+			b = 3 * (ctrl[0][coord] - 2 * ctrl[1][coord] + ctrl[2][coord]),
+			c = 3 * (ctrl[1][coord] - ctrl[0][coord]);
+
+		point[coord] = ctrl[0][coord];
+		delta1[coord] = a * step3 + b * step2 + c * step;
+		delta2[coord] = 6 * a * step3 + 2 * b * step2;
+		delta3[coord] = 6 * a * step3;
+	}
+
+	reserveMatrix(polyline, polyline->numPoints + segments);
+	int segment;
+	for(segment = 1; segment < segments; segment++){
+		for(coord = 0; coord < 3; coord++){
+			point[coord] += delta1[coord];
+			delta1[coord] += delta2[coord];
+			delta2[coord] += delta3[coord];
+		}
+		addPoint(polyline, POINT(point[X], point[Y], point[Z]));
+	}
+
+	// the last vertex is the curve's endpoint, free of accumulated error
+	addPoint(polyline, ctrl[3]);
+}
@@ -0,0 +1,61 @@
+/*!
+ *  @file
+ *  @brief Adaptive flattening of cubic curves into polylines.
+ *
+ *  Unlike ::addBezier() and ::addHermite(), which always take
+ *  ::CURVE_STEP_NUMBER samples, the functions here emit only as many points
+ *  as it takes for the polyline to stay within ::CURVE_TOLERANCE pixels of
+ *  the curve. A curve is split in half until each piece needs at most
+ *  ::CURVE_SPLIT_SEGMENTS segments, so that the density of points follows
+ *  the curvature, and each piece is then evaluated at evenly spaced
+ *  parameters by forward differencing.
+ */
+
+#pragma once
+
+#include "src/graphics/matrix.h"
+
+// The farthest, in pixels, a flattened curve may stray from the curve.
+#define CURVE_TOLERANCE 0.25
+
+// A piece of a curve that needs more segments than this is split in half.
+#define CURVE_SPLIT_SEGMENTS 16
+
+// The greatest number of times a curve is split in half.
+#define CURVE_MAX_DEPTH 10
+
+/*!
+ *  @brief Add the flattened polyline of a Bezier curve to a ::Matrix_t.
+ *
+ *  @param polyline The ::Matrix_t to add the polyline's vertices to, from
+ *      @p p1 to @p p4 inclusive.
+ *  @param p1 The first control point.
+ *  @param p2 The second control point.
+ *  @param p3 The third control point.
+ *  @param p4 The fourth control point.
+ */
+void flattenBezier(Matrix_t *polyline, Point_t *p1, Point_t *p2, Point_t *p3,
+	Point_t *p4);
+
+/*!
+ *  @brief Add the flattened polyline of a Hermite curve to a ::Matrix_t.
+ *
+ *  The control points have the same meaning as for ::addHermite().
+ *
+ *  @param polyline The ::Matrix_t to add the polyline's vertices to, from
+ *      @p p1 to @p p3 inclusive.
+ *  @param p1 The start of the curve.
+ *  @param p2 A point along the tangent at @p p1, relative to @p p1.
+ *  @param p3 The end of the curve.
+ *  @param p4 A point along the tangent at @p p3, relative to @p p3.
+ */
+void flattenHermite(Matrix_t *polyline, Point_t *p1, Point_t *p2, Point_t *p3,
+	Point_t *p4);
+
+/*!
+ *  @brief Draw a polyline with ::drawLine().
+ *
+ *  @param polyline The polyline's vertices, in order.
+ *  @param color The color of the polyline.
+ */
+void drawPolyline(const Matrix_t *polyline, int color);
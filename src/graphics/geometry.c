@@ -1,8 +1,14 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <tgmath.h>
 
+#include "src/arena.h"
 #include "src/graphics/geometry.h"
 #include "src/graphics/matrix.h"
+#include "src/graphics/mesh.h"
+#include "src/graphics/tessellation.h"
+#include "src/graphics/transform.h"
 
 /*!
  *  @brief Return the linear interpolation of numeric values @p a and @p b.
@@ -12,31 +18,112 @@
  */
 #define INTERPOL(a, b) (a + (b - a) * t1)
 
-//! The number of steps taken in plotting Bezier and Hermite curves.
-#define CURVE_STEP_NUMBER 1e3
-
 /*!
- *  @brief Return a pointer to a ::Matrix_t containing the points of a sphere.
+ *  @brief Add a sphere at a given tessellation level to a ::Mesh_t, from
+ *      ::g_tessellationCache if it's there.
  *
+ *  @param mesh A pointer to the ::Mesh_t to add the sphere to.
  *  @param origin The origin of the sphere.
  *  @param radius The radius of the sphere.
- *
- *  @return A pointer to a ::Matrix_t containing the points of the sphere.
+ *  @param level How finely to tessellate the sphere; its circles are
+ *      half-circles.
  */
-static Matrix_t * generateSphere(Point_t *origin, double radius);
+static void addSphereMeshLevel(Mesh_t *mesh, Point_t *origin, double radius,
+	const TessellationLevel_t *level);
 
 /*!
- *  @brief Return a pointer to a ::Matrix_t containing the points of a torus.
+ *  @brief Add a torus at a given tessellation level to a ::Mesh_t, from
+ *      ::g_tessellationCache if it's there.
  *
+ *  @param mesh A pointer to the ::Mesh_t to add the torus to.
  *  @param origin The origin of the torus.
- *  @param radius The radius of the torus.
+ *  @param rad1 The minor radius of the torus.
+ *  @param rad2 The major radius of the torus.
+ *  @param level How finely to tessellate the torus.
+ */
+static void addTorusMeshLevel(Mesh_t *mesh, Point_t *origin, double rad1,
+	double rad2, const TessellationLevel_t *level);
+
+/*!
+ *  @brief Add the vertices and faces of a sphere, centered on the origin, to
+ *      a ::Mesh_t.
+ *
+ *  @param mesh A pointer to the ::Mesh_t to add the sphere to.
+ *  @param radius The radius of the sphere.
+ *  @param level How finely to tessellate the sphere.
+ */
+static void tessellateSphere(Mesh_t *mesh, double radius,
+	const TessellationLevel_t *level);
+
+/*!
+ *  @brief Add the vertices and faces of a torus, centered on the origin, to
+ *      a ::Mesh_t.
+ *
+ *  @param mesh A pointer to the ::Mesh_t to add the torus to.
+ *  @param rad1 The minor radius of the torus.
+ *  @param rad2 The major radius of the torus.
+ *  @param level How finely to tessellate the torus.
+ */
+static void tessellateTorus(Mesh_t *mesh, double rad1, double rad2,
+	const TessellationLevel_t *level);
+
+/*!
+ *  @brief Return a pointer to a ::Matrix_t containing the points of a sphere
+ *      centered on the origin.
+ *
+ *  @param radius The radius of the sphere.
+ *  @param level How finely to tessellate the sphere.
+ *  @param normals Filled with the sphere's unit normal at each of the
+ *      returned points.
  *
- *  @return A pointer to a ::Matrix_t containing the points of the torus.
+ *  @return A pointer to a ::Matrix_t, allocated in ::g_frameArena,
+ *      containing ::TessellationLevel_t::circles circles of the sphere's
+ *      points.
  */
-static Matrix_t * generateTorus(Point_t *origin, double rad1, double rad2);
+static Matrix_t * generateSphere(double radius,
+	const TessellationLevel_t *level, Matrix_t *normals);
+
+/*!
+ *  @brief Return a pointer to a ::Matrix_t containing the points of a torus
+ *      centered on the origin.
+ *
+ *  @param rad1 The minor radius of the torus.
+ *  @param rad2 The major radius of the torus.
+ *  @param level How finely to tessellate the torus.
+ *  @param normals Filled with the torus's unit normal at each of the
+ *      returned points.
+ *
+ *  @return A pointer to a ::Matrix_t, allocated in ::g_frameArena,
+ *      containing ::TessellationLevel_t::circles circles of the torus's
+ *      points.
+ */
+static Matrix_t * generateTorus(double rad1, double rad2,
+	const TessellationLevel_t *level, Matrix_t *normals);
+
+/*!
+ *  @brief Add copies of a circle, swept around an axis, to a ::Matrix_t.
+ *
+ *  Copy @a k is @p circle rotated @p circles - @a k times, by @f$\frac{1}
+ *  {circles}@f$ of a turn each time. The copies are made from the last to the
+ *  first, each by rotating the previous one a further step, so the sweep
+ *  costs one rotation per point.
+ *
+ *  @param points The ::Matrix_t to add the copies to.
+ *  @param circle The circle to sweep; it's left rotated by a full turn.
+ *  @param axis The axis to sweep @p circle around.
+ *  @param circles The number of copies to add.
+ */
+static void sweepCircle(Matrix_t *points, Matrix_t *circle, int axis,
+	int circles);
+
+LevelOfDetail_t g_levelOfDetail = {
+	.minSegments = LOD_MIN_SEGMENTS,
+	.maxSegments = LOD_MAX_SEGMENTS,
+	.tolerance = LOD_TOLERANCE
+};
 
 Point_t * createPoint(Point_t * pt){
-	Point_t * point = malloc(4 * sizeof(double));
+	Point_t * point = arenaAlloc(&g_frameArena, 4 * sizeof(Point_t));
 	point[X] = pt[X];
 	point[Y] = pt[Y];
 	point[Z] = pt[Z];
@@ -46,7 +133,11 @@ Point_t * createPoint(Point_t * pt){
 
 void addPoint(Matrix_t * const matrix, Point_t * point){
 	expandMatrix(matrix);
-	matrix->points[matrix->numPoints - 1] = createPoint(point);
+	Point_t *newPoint = matrix->points[matrix->numPoints - 1];
+	newPoint[X] = point[X];
+	newPoint[Y] = point[Y];
+	newPoint[Z] = point[Z];
+	newPoint[W] = point[W];
 }
 
 void addEdge(Matrix_t * const matrix, Point_t * p1, Point_t * p2){
@@ -57,6 +148,7 @@ void addEdge(Matrix_t * const matrix, Point_t * p1, Point_t * p2){
 
 void addTriangle(Matrix_t * const matrix, Point_t * p1, Point_t * p2,
 	Point_t * p3){
+	reserveMatrix(matrix, matrix->numPoints + 3);
 	addPoint(matrix, p1);
 	addPoint(matrix, p2);
 	addPoint(matrix, p3);
@@ -64,8 +156,8 @@ void addTriangle(Matrix_t * const matrix, Point_t * p1, Point_t * p2,
 
 void addPolygonFull(Matrix_t * points, Point_t *origin, int radius, int
 	numSides, double theta){
-	double tanFactor = tan(theta), radFactor = cos(theta);
-	double x = radius, y = 0;
+	Point_t tanFactor = mathTan(theta), radFactor = mathCos(theta);
+	Point_t x = radius, y = 0;
 
 	int segment;
 	for(segment = 0; segment < numSides; segment++){
@@ -81,7 +173,7 @@ void addBezier(Matrix_t * points, Point_t *p1, Point_t *p2, Point_t *p3,
 	Point_t *p4){
 
 	int t;
-	double t1, abX, bcX, cdX, abbcX, bccdX, abY, bcY, cdY, bccdY, abbcY;
+	Point_t t1, abX, bcX, cdX, abbcX, bccdX, abY, bcY, cdY, bccdY, abbcY;
 	for(t = 0; t < CURVE_STEP_NUMBER; t++){
 		t1 = t / CURVE_STEP_NUMBER;
 		abX = INTERPOL(p1[X], p2[X]);
@@ -135,146 +227,316 @@ void addHermite(Matrix_t * points, Point_t *p1, Point_t *p2, Point_t *p3,
 }
 
 void addRectangularPrism(Matrix_t *pts, Point_t *p1, Point_t *p2){
-	Point_t *a = p1; // front, top-left
-	Point_t *b = POINT(p1[X], p1[Y] - p2[Y], p1[Z]); // front, bottom-left
-	Point_t *c = POINT(p1[X] + p2[X], p1[Y] - p2[Y], p1[Z]); // front, bottom-rt
-	Point_t *d = POINT(p1[X] + p2[X], p1[Y], p1[Z]); // front, top-right
-	Point_t *e = POINT(a[X], a[Y], a[Z] - p2[Z]); // back, top-left
-	Point_t *f = POINT(b[X], b[Y], b[Z] - p2[Z]); // back, bottom-left
-	Point_t *g = POINT(c[X], c[Y], c[Z] - p2[Z]); // back, bottom-right
-	Point_t *h = POINT(d[X], d[Y], d[Z] - p2[Z]); // back, top-right
+	Mesh_t *mesh = createMesh();
+	addRectangularPrismMesh(mesh, p1, p2);
+	addMesh(pts, mesh);
+	freeMesh(mesh);
+}
+
+void addSphere(Matrix_t * points, Point_t *origin, double radius){
+	Mesh_t *mesh = createMesh();
+	addSphereMesh(mesh, origin, radius);
+	addMesh(points, mesh);
+	freeMesh(mesh);
+}
+
+void addTorus(Matrix_t * points, Point_t *origin, double rad1, double rad2){
+	Mesh_t *mesh = createMesh();
+	addTorusMesh(mesh, origin, rad1, rad2);
+	addMesh(points, mesh);
+	freeMesh(mesh);
+}
+
+void addRectangularPrismMesh(Mesh_t *mesh, Point_t *p1, Point_t *p2){
+	// front, top-left
+	int a = addMeshVertex(mesh, p1);
+	// front, bottom-left
+	int b = addMeshVertex(mesh, POINT(p1[X], p1[Y] - p2[Y], p1[Z]));
+	// front, bottom-right
+	int c = addMeshVertex(mesh, POINT(p1[X] + p2[X], p1[Y] - p2[Y], p1[Z]));
+	// front, top-right
+	int d = addMeshVertex(mesh, POINT(p1[X] + p2[X], p1[Y], p1[Z]));
+
+	// back, top-left; back, bottom-left; back, bottom-right; back, top-right
+	int e = addMeshVertex(mesh, POINT(p1[X], p1[Y], p1[Z] - p2[Z]));
+	int f = addMeshVertex(mesh, POINT(p1[X], p1[Y] - p2[Y], p1[Z] - p2[Z]));
+	int g = addMeshVertex(mesh,
+		POINT(p1[X] + p2[X], p1[Y] - p2[Y], p1[Z] - p2[Z]));
+	int h = addMeshVertex(mesh, POINT(p1[X] + p2[X], p1[Y], p1[Z] - p2[Z]));
+
+	reserveMesh(mesh, mesh->numIndices / 3 + 12);
 
 	// front xz face
-	addTriangle(pts, a, b, c);
-	addTriangle(pts, a, c, d);
+	addMeshTriangle(mesh, a, b, c);
+	addMeshTriangle(mesh, a, c, d);
 
 	// back xz face
-	addTriangle(pts, f, e, h);
-	addTriangle(pts, f, h, g);
+	addMeshTriangle(mesh, f, e, h);
+	addMeshTriangle(mesh, f, h, g);
 
 	// top xy face
-	addTriangle(pts, e, a, d);
-	addTriangle(pts, e, d, h);
+	addMeshTriangle(mesh, e, a, d);
+	addMeshTriangle(mesh, e, d, h);
 
 	// bottom xy face
-	addTriangle(pts, b, f, g);
-	addTriangle(pts, b, g, c);
+	addMeshTriangle(mesh, b, f, g);
+	addMeshTriangle(mesh, b, g, c);
 
 	// left yz face
-	addTriangle(pts, e, f, b);
-	addTriangle(pts, e, b, a);
+	addMeshTriangle(mesh, e, f, b);
+	addMeshTriangle(mesh, e, b, a);
 
 	// right yz face
-	addTriangle(pts, d, c, g);
-	addTriangle(pts, d, g, h);
+	addMeshTriangle(mesh, d, c, g);
+	addMeshTriangle(mesh, d, g, h);
 }
 
-void addSphere(Matrix_t * points, Point_t *origin, double radius){
-	Matrix_t * sphere = generateSphere(origin, radius);
-	int circlePts = sphere->numPoints / (360 / CIRCLE_STEP_SIZE);
+void addSphereMesh(Mesh_t *mesh, Point_t *origin, double radius){
+	int numSides = radius / 2;
+	TessellationLevel_t level = {
+		.sides = numSides + numSides % 2,
+		.theta = 2 * M_PI / radius,
+		.circles = 360 / CIRCLE_STEP_SIZE
+	};
+	addSphereMeshLevel(mesh, origin, radius, &level);
+}
+
+void addTorusMesh(Mesh_t *mesh, Point_t *origin, double rad1, double rad2){
+	TessellationLevel_t level = {
+		.sides = rad1,
+		.theta = 2 * M_PI / rad1,
+		.circles = 360 / CIRCLE_STEP_SIZE
+	};
+	addTorusMeshLevel(mesh, origin, rad1, rad2, &level);
+}
+
+int circleSegments(double radius, const Mat4_t *transform){
+	// the radius, in pixels, of the circle's projection is at most @p radius
+	// times the largest singular value of the transformation's x and y rows
+	Point_t xx = 0, yy = 0, xy = 0;
+	int col;
+	for(col = 0; col < 3; col++){
+		xx += MAT4(transform, X, col) * MAT4(transform, X, col);
+		yy += MAT4(transform, Y, col) * MAT4(transform, Y, col);
+		xy += MAT4(transform, X, col) * MAT4(transform, Y, col);
+	}
+	double mean = (xx + yy) / 2, spread = (xx - yy) / 2,
+		screenRadius = radius * sqrt(mean + sqrt(spread * spread + xy * xy));
+
+	// a regular n-gon strays at most r(1 - cos(pi / n)) from its circle
+	int segments = g_levelOfDetail.maxSegments;
+	if(screenRadius <= g_levelOfDetail.tolerance)
+		segments = g_levelOfDetail.minSegments;
+	else {
+		double needed = ceil(M_PI /
+			acos(1 - g_levelOfDetail.tolerance / screenRadius));
+		if(needed < segments)
+			segments = needed;
+	}
+
+	if(segments < g_levelOfDetail.minSegments)
+		segments = g_levelOfDetail.minSegments;
+	return segments + segments % 2;
+}
+
+void addSphereMeshLOD(Mesh_t *mesh, Point_t *origin, double radius,
+	const Mat4_t *transform){
+	int segments = circleSegments(radius, transform);
+	TessellationLevel_t level = {
+		.sides = segments / 2,
+		.theta = 2 * M_PI / segments,
+		.circles = segments
+	};
+	addSphereMeshLevel(mesh, origin, radius, &level);
+}
+
+void addTorusMeshLOD(Mesh_t *mesh, Point_t *origin, double rad1, double rad2,
+	const Mat4_t *transform){
+	int sides = circleSegments(rad1, transform);
+	TessellationLevel_t level = {
+		.sides = sides,
+		.theta = 2 * M_PI / sides,
+		.circles = circleSegments(rad1 + rad2, transform)
+	};
+	addTorusMeshLevel(mesh, origin, rad1, rad2, &level);
+}
+
+static void addSphereMeshLevel(Mesh_t *mesh, Point_t *origin, double radius,
+	const TessellationLevel_t *level){
+	TessellationKey_t key = {
+		.shape = SHAPE_SPHERE,
+		.rad1 = radius,
+		.level = *level
+	};
+
+	Mesh_t *sphere = findTessellation(&g_tessellationCache, &key);
+	if(sphere == NULL){
+		sphere = createMesh();
+		tessellateSphere(sphere, radius, level);
+		cacheTessellation(&g_tessellationCache, &key, sphere);
+	}
+	addTranslatedMesh(mesh, sphere, origin);
+}
+
+static void addTorusMeshLevel(Mesh_t *mesh, Point_t *origin, double rad1,
+	double rad2, const TessellationLevel_t *level){
+	TessellationKey_t key = {
+		.shape = SHAPE_TORUS,
+		.rad1 = rad1,
+		.rad2 = rad2,
+		.level = *level
+	};
+
+	Mesh_t *torus = findTessellation(&g_tessellationCache, &key);
+	if(torus == NULL){
+		torus = createMesh();
+		tessellateTorus(torus, rad1, rad2, level);
+		cacheTessellation(&g_tessellationCache, &key, torus);
+	}
+	addTranslatedMesh(mesh, torus, origin);
+}
+
+static void tessellateSphere(Mesh_t *mesh, double radius,
+	const TessellationLevel_t *level){
+	Matrix_t * normals = createArenaMatrix(&g_frameArena),
+		* sphere = generateSphere(radius, level, normals);
+	int circlePts = sphere->numPoints / level->circles;
+	int first = addMeshVertices(mesh, sphere, normals);
+	reserveMesh(mesh, mesh->numIndices / 3 +
+		2 * level->circles * (circlePts - 2));
 
 	int circle, point;
-	for(circle = 0; circle < 360 / CIRCLE_STEP_SIZE - 1; circle++){
-		int circleStart = circle * circlePts;
+	for(circle = 0; circle < level->circles - 1; circle++){
+		int circleStart = first + circle * circlePts;
 		for(point = 0; point < circlePts - 2; point++){
-			addTriangle(points,
-				(sphere->points[circleStart + point + 1]),
-				(sphere->points[circleStart + point]),
-				(sphere->points[circleStart + circlePts + point + 1])
+			addMeshTriangle(mesh,
+				circleStart + point + 1,
+				circleStart + point,
+				circleStart + circlePts + point + 1
 			);
-			addTriangle(points,
-				(sphere->points[circleStart + point]),
-				(sphere->points[circleStart + circlePts + point]),
-				(sphere->points[circleStart + circlePts + point + 1])
+			addMeshTriangle(mesh,
+				circleStart + point,
+				circleStart + circlePts + point,
+				circleStart + circlePts + point + 1
 			);
 		}
 	}
 
 	for(point = sphere->numPoints - circlePts; point < sphere->numPoints - 2;
 		point++){
-		addTriangle(points,
-			(sphere->points[point + 1]),
-			(sphere->points[point]),
-			(sphere->points[(point + 1) % circlePts])
+		addMeshTriangle(mesh,
+			first + point + 1,
+			first + point,
+			first + (point + 1) % circlePts
 		);
-		addTriangle(points,
-			(sphere->points[(point + 1) % circlePts]),
-			(sphere->points[point]),
-			(sphere->points[point % circlePts])
+		addMeshTriangle(mesh,
+			first + (point + 1) % circlePts,
+			first + point,
+			first + point % circlePts
 		);
 	}
 
-	freeMatrix(sphere);
 }
 
-void addTorus(Matrix_t * points, Point_t *origin, double rad1, double rad2){
-	Matrix_t * torus = generateTorus(origin, rad1, rad2);
-	int circlePts = torus->numPoints / (360 / CIRCLE_STEP_SIZE);
+static void tessellateTorus(Mesh_t *mesh, double rad1, double rad2,
+	const TessellationLevel_t *level){
+	Matrix_t * normals = createArenaMatrix(&g_frameArena),
+		* torus = generateTorus(rad1, rad2, level, normals);
+	int circlePts = torus->numPoints / level->circles;
+	int first = addMeshVertices(mesh, torus, normals);
+	reserveMesh(mesh, mesh->numIndices / 3 +
+		2 * level->circles * (circlePts - 1));
 
 	int circle, point;
-	for(circle = 0; circle < 360 / CIRCLE_STEP_SIZE - 1; circle++){
-		int circleStart = circle * circlePts;
+	for(circle = 0; circle < level->circles - 1; circle++){
+		int circleStart = first + circle * circlePts;
 		for(point = 0; point < circlePts - 1; point++){
-			addTriangle(points,
-				torus->points[circleStart + point + 1],
-				torus->points[circleStart + point],
-				torus->points[circleStart + circlePts + point + 1]
+			addMeshTriangle(mesh,
+				circleStart + point + 1,
+				circleStart + point,
+				circleStart + circlePts + point + 1
 			);
-			addTriangle(points,
-				torus->points[circleStart + point],
-				torus->points[circleStart + circlePts + point],
-				torus->points[circleStart + circlePts + point + 1]
+			addMeshTriangle(mesh,
+				circleStart + point,
+				circleStart + circlePts + point,
+				circleStart + circlePts + point + 1
 			);
 		}
 	}
 
-	int circleStart = torus->numPoints - circlePts;
+	int circleStart = first + torus->numPoints - circlePts;
 	for(point = 0; point < circlePts - 1; point++){
-		addTriangle(points,
-			torus->points[circleStart + point + 1],
-			torus->points[circleStart + point],
-			torus->points[point + 1]
+		addMeshTriangle(mesh,
+			circleStart + point + 1,
+			circleStart + point,
+			first + point + 1
 		);
-		addTriangle(points,
-			torus->points[point + 1],
-			torus->points[circleStart + point],
-			torus->points[point]
+		addMeshTriangle(mesh,
+			first + point + 1,
+			circleStart + point,
+			first + point
 		);
 	}
 
-	freeMatrix(torus);
 }
 
-static Matrix_t * generateSphere(Point_t *origin, double radius){
-	Matrix_t * sphere = createMatrix(),
-		* xRot = createRotation(X_AXIS, CIRCLE_STEP_SIZE);
-
-	int degree;
-	for(degree = 0; degree < 360; degree += CIRCLE_STEP_SIZE){
-		addHalfCircle(sphere, POINT(0, 0), radius);
-		multiplyMatrix(xRot, sphere);
+static Matrix_t * generateSphere(double radius,
+	const TessellationLevel_t *level, Matrix_t *normals){
+	Matrix_t * halfCircle = createArenaMatrix(&g_frameArena),
+		* sphere = createArenaMatrix(&g_frameArena);
+	addPolygonFull(halfCircle, POINT(0, 0), radius, level->sides,
+		level->theta);
+	sweepCircle(sphere, halfCircle, X_AXIS, level->circles);
+
+	// every point of a sphere centered on the origin is its own normal
+	reserveMatrix(normals, normals->numPoints + sphere->numPoints);
+	int point;
+	for(point = 0; point < sphere->numPoints; point++){
+		Point_t *pt = sphere->points[point];
+		Point_t length = sqrt(pt[X] * pt[X] + pt[Y] * pt[Y] + pt[Z] * pt[Z]);
+		addPoint(normals,
+			POINT(pt[X] / length, pt[Y] / length, pt[Z] / length, 0));
 	}
 
-	Matrix_t * translation = createTranslation(origin);
-	multiplyMatrix(translation, sphere);
-
-	freeMatrices(2, xRot, translation);
 	return sphere;
 }
 
-static Matrix_t * generateTorus(Point_t *origin, double rad1, double rad2){
-	Matrix_t * torus = createMatrix();
-	Matrix_t * yRot = createRotation(Y_AXIS, CIRCLE_STEP_SIZE);
-
-	int degree;
-	for(degree = 0; degree < 360; degree += CIRCLE_STEP_SIZE){
-		addCircle(torus, POINT(rad2, 0), rad1);
-		multiplyMatrix(yRot, torus);
+static Matrix_t * generateTorus(double rad1, double rad2,
+	const TessellationLevel_t *level, Matrix_t *normals){
+	Matrix_t * crossSection = createArenaMatrix(&g_frameArena),
+		* torus = createArenaMatrix(&g_frameArena);
+	addPolygonFull(crossSection, POINT(rad2, 0), rad1, level->sides,
+		level->theta);
+	sweepCircle(torus, crossSection, Y_AXIS, level->circles);
+
+	// a point's normal leads away from the center of its cross-section, which
+	// lies @p rad2 from the origin, in the point's direction in the xz-plane
+	reserveMatrix(normals, normals->numPoints + torus->numPoints);
+	int point;
+	for(point = 0; point < torus->numPoints; point++){
+		Point_t *pt = torus->points[point];
+		Point_t scale = 1 - rad2 / sqrt(pt[X] * pt[X] + pt[Z] * pt[Z]);
+		Point_t normal[4] = {pt[X] * scale, pt[Y], pt[Z] * scale, 0};
+		Point_t length = sqrt(dotProduct(normal, normal));
+		addPoint(normals, POINT(normal[X] / length, normal[Y] / length,
+			normal[Z] / length, 0));
 	}
 
-	Matrix_t * translation = createTranslation(origin);
-	multiplyMatrix(translation, torus);
-
-	freeMatrices(2, yRot, translation);
 	return torus;
 }
+
+static void sweepCircle(Matrix_t *points, Matrix_t *circle, int axis,
+	int circles){
+	Mat4_t step = rotationMat4(axis, 360.0 / circles);
+	int circlePts = circle->numPoints,
+		first = points->numPoints;
+	reserveMatrix(points, first + circles * circlePts);
+	points->numPoints += circles * circlePts;
+
+	int copy;
+	for(copy = circles - 1; copy >= 0; copy--){
+		applyMat4(&step, circle);
+		memcpy(points->points[first + copy * circlePts], circle->points,
+			circlePts * sizeof(*circle->points));
+	}
+}
@@ -3,12 +3,14 @@
  * @brief Constructs for shape creation.
  *
  * A collection of functions and macros used to add various shapes
- * (eg, tori, spheres) to ::Matrix_t.
+ * (eg, tori, spheres) to ::Matrix_t, or, as indexed meshes, to ::Mesh_t.
 */
 
 #pragma once
 
 #include "src/graphics/matrix.h"
+#include "src/graphics/mesh.h"
+#include "src/graphics/transform.h"
 
 /*
  *  @brief Add a circle to a ::Matrix_t.
@@ -50,9 +52,28 @@
 #define addPolygon(points, origin, radius, numSides) \
 	addPolygonFull(points, origin, radius, numSides, 2 * M_PI / numSides)
 
-// The angle between the subsequent, rotated circles that compose a sphere.
+// The number of steps taken in plotting Bezier and Hermite curves.
+#define CURVE_STEP_NUMBER 1e3
+
+// The angle between the subsequent, rotated circles that compose a sphere or
+// torus, at the tessellation level of ::addSphereMesh() and ::addTorusMesh().
 #define CIRCLE_STEP_SIZE 2
 
+// The defaults of ::g_levelOfDetail.
+#define LOD_MIN_SEGMENTS 8
+#define LOD_MAX_SEGMENTS 360
+#define LOD_TOLERANCE 0.5
+
+//! Limits on the tessellation chosen by ::circleSegments().
+typedef struct {
+	int minSegments; //! The fewest segments in any circle.
+	int maxSegments; //! The most segments in any circle.
+	double tolerance; //! The farthest, in pixels, a circle's polygon may stray.
+} LevelOfDetail_t;
+
+//! The limits used to tessellate the interpreter's spheres and tori.
+extern LevelOfDetail_t g_levelOfDetail;
+
 /*!
  *  @brief Add a line's endpoints to a ::Matrix_t.
  *
@@ -125,9 +146,8 @@ void addRectangularPrism(Matrix_t *pts, Point_t *p1, Point_t *p2);
 /*!
  *  @brief Add the points of a sphere to a ::Matrix_t.
  *
- *  Internally calls ::generateSphere(), and adds the points of the returned
- *  ::Matrix_t to @p points in such a manner as to facilitate proper triangular
- *  rendering.
+ *  Expands the mesh built by ::addSphereMesh() into @p points, in such a
+ *  manner as to facilitate proper triangular rendering.
  *
  *  @param points A pointer to the ::Matrix_t to add the sphere's points to.
  *  @param origin The origin of the sphere.
@@ -138,9 +158,8 @@ void addSphere(Matrix_t *points, Point_t *origin, double radius);
 /*!
  *  @brief Add the points of a torus to a ::Matrix_t.
  *
- *  Internally calls ::generateTorus(), and adds the points of the returned
- *  ::Matrix_t to @p points in such a manner as to facilitate proper triangular
- *  rendering.
+ *  Expands the mesh built by ::addTorusMesh() into @p points, in such a
+ *  manner as to facilitate proper triangular rendering.
  *
  *  @param points A pointer to the ::Matrix_t to add the torus's points to.
  *  @param origin The origin of the torus.
@@ -148,3 +167,85 @@ void addSphere(Matrix_t *points, Point_t *origin, double radius);
  *  @param rad2 The major radius of the torus.
  */
 void addTorus(Matrix_t *points, Point_t *origin, double rad1, double rad2);
+
+/*!
+ *  @brief Add the vertices and faces of a rectangular prism to a ::Mesh_t.
+ *
+ *  @param mesh A pointer to the ::Mesh_t to add the prism to.
+ *  @param p1 The front-top-left vertex of the prism.
+ *  @param p2 The width, height and depth of the prism.
+ */
+void addRectangularPrismMesh(Mesh_t *mesh, Point_t *p1, Point_t *p2);
+
+/*!
+ *  @brief Add the vertices and faces of a sphere to a ::Mesh_t.
+ *
+ *  The sphere is tessellated around the origin, with each vertex shared by
+ *  the (up to six) triangles that meet there, and cached in
+ *  ::g_tessellationCache; later spheres of the same radius are copied from
+ *  the cache and translated to @p origin.
+ *
+ *  @param mesh A pointer to the ::Mesh_t to add the sphere to.
+ *  @param origin The origin of the sphere.
+ *  @param radius The radius of the sphere.
+ */
+void addSphereMesh(Mesh_t *mesh, Point_t *origin, double radius);
+
+/*!
+ *  @brief Add the vertices and faces of a torus to a ::Mesh_t.
+ *
+ *  Like ::addSphereMesh(), the torus is tessellated around the origin once
+ *  per pair of radii, and copied from ::g_tessellationCache afterwards.
+ *
+ *  @param mesh A pointer to the ::Mesh_t to add the torus to.
+ *  @param origin The origin of the torus.
+ *  @param rad1 The minor radius of the torus.
+ *  @param rad2 The major radius of the torus.
+ */
+void addTorusMesh(Mesh_t *mesh, Point_t *origin, double rad1, double rad2);
+
+/*!
+ *  @brief Choose the number of segments for a circle on the screen.
+ *
+ *  The circle's on-screen radius is bounded by its radius times the largest
+ *  scaling that @p transform applies in the screen's plane, and the count is
+ *  the fewest segments whose polygon stays within ::g_levelOfDetail's
+ *  tolerance of that circle, clamped to its limits.
+ *
+ *  @param radius The radius of the circle, before @p transform.
+ *  @param transform The transformation the circle will be drawn under.
+ *
+ *  @return An even number of segments.
+ */
+int circleSegments(double radius, const Mat4_t *transform);
+
+/*!
+ *  @brief Add a sphere to a ::Mesh_t, tessellated for its size on the screen.
+ *
+ *  Like ::addSphereMesh(), but the number of segments in each circle, and of
+ *  circles, is chosen by ::circleSegments(), so that small or distant
+ *  spheres get proportionally fewer triangles.
+ *
+ *  @param mesh A pointer to the ::Mesh_t to add the sphere to.
+ *  @param origin The origin of the sphere.
+ *  @param radius The radius of the sphere.
+ *  @param transform The transformation the sphere will be drawn under.
+ */
+void addSphereMeshLOD(Mesh_t *mesh, Point_t *origin, double radius,
+	const Mat4_t *transform);
+
+/*!
+ *  @brief Add a torus to a ::Mesh_t, tessellated for its size on the screen.
+ *
+ *  Like ::addTorusMesh(), but its cross-sections are tessellated by
+ *  ::circleSegments() for @p rad1, and swept around the torus's axis in as
+ *  many steps as it chooses for @p rad1 + @p rad2.
+ *
+ *  @param mesh A pointer to the ::Mesh_t to add the torus to.
+ *  @param origin The origin of the torus.
+ *  @param rad1 The minor radius of the torus.
+ *  @param rad2 The major radius of the torus.
+ *  @param transform The transformation the torus will be drawn under.
+ */
+void addTorusMeshLOD(Mesh_t *mesh, Point_t *origin, double rad1, double rad2,
+	const Mat4_t *transform);
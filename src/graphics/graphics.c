@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <string.h>
+#include <tgmath.h>
 
 #include "src/graphics/graphics.h"
 #include "src/graphics/screen.h"
@@ -19,28 +21,75 @@
  * @param l2 (::Light_t *) The second light endpoint.
  * @param guide (::Point_t *) A point along the line formed by @p l1 and @p l2.
  * @param axis (int) Determines which axis to interpolate along: either X or Y.
+ * @param result (::RGB_t *) Set to the interpolated color.
 */
-#define INTERPOLATE_COLOR(l1, l2, guide, axis) \
-	({\
+#define INTERPOLATE_COLOR(l1, l2, guide, axis, result) \
+	do {\
 		if(l1->pos[axis] > l2->pos[axis]){\
 			Light_t *tmp = l1;\
 			l1 = l2;\
 			l2 = tmp;\
 		}\
 		\
-		double divisor = 1.0 / (l2->pos[axis] - l1->pos[axis]),\
+		Point_t divisor = 1 / (l2->pos[axis] - l1->pos[axis]),\
 			colCoef1 = divisor * (l2->pos[axis] - guide[axis]),\
 			colCoef2 = divisor * (guide[axis] - l1->pos[axis]);\
-		RGB(\
-			colCoef1 * l1->color[R] + colCoef2 * l2->color[R],\
-			colCoef1 * l1->color[G] + colCoef2 * l2->color[G],\
-			colCoef1 * l1->color[B] + colCoef2 * l2->color[B]\
-		);\
-	})
+		result[R] = colCoef1 * l1->color[R] + colCoef2 * l2->color[R];\
+		result[G] = colCoef1 * l1->color[G] + colCoef2 * l2->color[G];\
+		result[B] = colCoef1 * l1->color[B] + colCoef2 * l2->color[B];\
+	} while(0)
+
+/*
+ * @brief Return the least or greatest of three fixed-point coordinates.
+ *
+ * @param coords (long long [3]) The coordinates.
+*/
+#define FIXED_MIN(coords) \
+	((coords[0] < coords[1])?\
+		((coords[0] < coords[2])?coords[0]:coords[2]):\
+		((coords[1] < coords[2])?coords[1]:coords[2]))
+#define FIXED_MAX(coords) \
+	((coords[0] > coords[1])?\
+		((coords[0] > coords[2])?coords[0]:coords[2]):\
+		((coords[1] > coords[2])?coords[1]:coords[2]))
+
+/*
+ * @brief Whether a scanline's row lies within ::g_clipRect.
+ *
+ * @param guide (::Point_t *) A point on the scanline.
+*/
+#define VISIBLE_ROW(guide) \
+	(g_clipRect.minY <= (int)(guide[Y] + g_screenHeight / 2) &&\
+		(int)(guide[Y] + g_screenHeight / 2) <= g_clipRect.maxY)
+
+// The rounding error allowed in the edge rasterizer's interpolated depths,
+// relative to the terms they're summed from.
+#define DEPTH_ROUNDING 1e-4
+
+// The number of fractional bits in the colors stepped along a span by
+// ::drawHorizontalGradientLine(), and the fraction of a color unit they start
+// with.
+#define SPAN_COLOR_BITS 32
+#define SPAN_COLOR_BIAS (1LL << (SPAN_COLOR_BITS - 20))
 
 // The exponential rate at which specular light diffuses.
 #define SPECULAR_FADE_CONSTANT 100
 
+// A line as ::drawLine() walks it: from its first pixel, every step moves it
+// diagonally, by (dx1, dy1), whenever the running numerator, advanced by
+// shortDist, reaches longDist, and straight, by (dx2, dy2), otherwise.
+typedef struct {
+	Point_t x, y; // The position of the first pixel.
+	int dx1, dy1, dx2, dy2; // The diagonal and straight steps.
+	unsigned int longDist, shortDist; // The numerator's period and increment.
+} LineWalk_t;
+
+// A vertex of a triangle being clipped to the edge rasterizer's guard band.
+typedef struct {
+	Point_t pos[4]; // The vertex's position.
+	Point_t color[3]; // The vertex's color, before rounding.
+} ClipVertex_t;
+
 /*
  * @brief Convert an ::RGB_t to an int.
  *
@@ -60,10 +109,107 @@ static inline unsigned int rgbToInt(RGB_t *color);
  * @return The inverse slope (delta x)/(delta y) of the line formed by endpoints
  *      @p p1 and @p p2.
 */
-static inline double inverseSlope(Point_t *p1, Point_t *p2);
+static inline Point_t inverseSlope(Point_t *p1, Point_t *p2);
+
+/*
+ * @brief Find the position of a line's pixel after a number of steps.
+ *
+ * @param line The line.
+ * @param steps The number of steps from the line's first pixel.
+ * @param column Set to the pixel's column, as ::plotPixel() would compute it.
+ * @param row Set to the pixel's row, as ::plotPixel() would compute it.
+*/
+static void linePixel(const LineWalk_t *line, unsigned int steps, int *column,
+	int *row);
+
+/*
+ * @brief Return whether a line's pixel lies outside a rectangle, on the side
+ *      that the line enters it from or the side that it leaves it by.
+ *
+ * Since both of a line's steps move it the same way along each axis, a line
+ * is on the entry side for a run of its first pixels, and on the exit side
+ * for a run of its last.
+ *
+ * @param line The line.
+ * @param rect The rectangle.
+ * @param steps The number of steps from the line's first pixel.
+ * @param entry Whether to test the entry side, rather than the exit side.
+*/
+static int lineOutside(const LineWalk_t *line, const PixelRect_t *rect,
+	unsigned int steps, int entry);
+
+/*
+ * @brief Whether a point lies within the edge rasterizer's guard band; see
+ *      ::RASTER_MAX_COORDINATE.
+ *
+ * @param pos The point.
+*/
+static inline int insideGuardBand(const Point_t *pos);
+
+/*
+ * @brief Clip a triangle to the edge rasterizer's guard band, and fill the
+ *      resulting polygon as a fan of triangles with ::edgeRender().
+ *
+ * @param l1 The position and color of the first vertex of the triangle.
+ * @param l2 The position and color of the second vertex of the triangle.
+ * @param l3 The position and color of the third vertex of the triangle.
+*/
+static void guardBandRender(Light_t *l1, Light_t *l2, Light_t *l3);
+
+/*
+ * @brief Fill a triangle with the edge rasterizer; see ::scanlineRender().
+ *
+ * Skips the triangle unless it lies within the guard band.
+ *
+ * @param l1 The position and color of the first vertex of the triangle.
+ * @param l2 The position and color of the second vertex of the triangle.
+ * @param l3 The position and color of the third vertex of the triangle.
+*/
+static void edgeRender(Light_t *l1, Light_t *l2, Light_t *l3);
+
+/*
+ * @brief Test a triangle for ::scanlineRender() against the coarse depth of
+ *      ::g_zbuffer, and count the test in ::g_depthStats.
+ *
+ * @param bounds The triangle's ::triangleBounds(), clipped with ::clipRect().
+ * @param l1 The position and color of the first vertex of the triangle.
+ * @param l2 The position and color of the second vertex of the triangle.
+ * @param l3 The position and color of the third vertex of the triangle.
+ *
+ * @return Whether the triangle is hidden wherever it would draw.
+*/
+static int hiddenTriangle(const PixelRect_t *bounds, Light_t *l1, Light_t *l2,
+	Light_t *l3);
+
+/*
+ * @brief Return the greatest value a plane takes at the pixel centers of a
+ *      rectangle, allowing for the edge rasterizer's rounding.
+ *
+ * @param rect The rectangle.
+ * @param value The plane's value at a point.
+ * @param fromX The x-offset of the center of @p rect's first pixel from that
+ *      point.
+ * @param fromY The y-offset of the center of @p rect's first pixel from that
+ *      point.
+ * @param gradX The plane's change per pixel along the x-axis.
+ * @param gradY The plane's change per pixel along the y-axis.
+*/
+static inline Point_t planeMax(const PixelRect_t *rect, Point_t value,
+	Point_t fromX, Point_t fromY, Point_t gradX, Point_t gradY);
+
+/*
+ * @brief Clamp an interpolated color channel to the range of an ::RGB_t.
+ *
+ * @param value The channel's value.
+*/
+static inline unsigned int clampChannel(Point_t value);
+
+extern int g_screenWidth, g_screenHeight;
+extern ZBuffer_t *g_zbuffer;
+
+int g_rasterizer = RASTERIZER_SCANLINE;
 
 void (drawLine)(Point_t *p1, Point_t *p2, int color){
-	p1 = COPY_POINT(p1);
 	int width = p2[X] - p1[X],
 		height = p2[Y] - p1[Y];
 	int dx1 = 0,
@@ -87,18 +233,62 @@ void (drawLine)(Point_t *p1, Point_t *p2, int color){
 		dx2 = 0;
 	}
 
-	unsigned int numerator = longDist >> 1, pixel;
-	for(pixel = 0; pixel <= longDist; pixel++){
-		plotPixel(p1, color);
+	PixelRect_t clip = {0, 0, g_screenWidth - 1, g_screenHeight - 1};
+	LineWalk_t line = {
+		p1[X], p1[Y], dx1, dy1, dx2, dy2, longDist, shortDist
+	};
+	if(!clipRect(&clip) || lineOutside(&line, &clip, 0, 0) ||
+		lineOutside(&line, &clip, longDist, 1))
+		return;
+
+	// bisect for the first pixel past the entry side, and the last before the
+	// exit side, unless the endpoints trivially are
+	unsigned int first = 0, last = longDist, low, high, middle;
+	if(lineOutside(&line, &clip, first, 1)){
+		for(low = 0, high = longDist; high - low > 1;){
+			middle = low + (high - low) / 2;
+			if(lineOutside(&line, &clip, middle, 1))
+				low = middle;
+			else
+				high = middle;
+		}
+		first = high;
+	}
+	if(lineOutside(&line, &clip, last, 0)){
+		for(low = 0, high = longDist; high - low > 1;){
+			middle = low + (high - low) / 2;
+			if(lineOutside(&line, &clip, middle, 0))
+				high = middle;
+			else
+				low = middle;
+		}
+		last = low;
+	}
+	if(last < first)
+		return;
+
+	// the offsets from p1 are whole, and added to it as in linePixel(), so
+	// that every walked pixel is one that the bisection tested as visible
+	unsigned long long progress = (longDist >> 1) +
+		(unsigned long long)first * shortDist;
+	unsigned int numerator = progress % longDist,
+		diagonal = progress / longDist, pixel;
+	long long offsetX = (long long)diagonal * dx1 +
+			(long long)(first - diagonal) * dx2,
+		offsetY = (long long)diagonal * dy1 +
+			(long long)(first - diagonal) * dy2;
+	for(pixel = first; pixel <= last; pixel++){
+		writePixel(g_zbuffer, p1[X] + offsetX + g_screenWidth / 2,
+			p1[Y] + offsetY + g_screenHeight / 2, p1[Z], color);
 		numerator += shortDist;
 		if(numerator >= longDist){
 			numerator -= longDist;
-			p1[X] += dx1;
-			p1[Y] += dy1;
+			offsetX += dx1;
+			offsetY += dy1;
 		}
 		else {
-			p1[X] += dx2;
-			p1[Y] += dy2;
+			offsetX += dx2;
+			offsetY += dy2;
 		}
 	}
 }
@@ -109,17 +299,98 @@ void drawHorizontalGradientLine(Light_t *light1, Light_t *light2){
 		light1 = light2;
 		light2 = tmp;
 	}
-	Point_t *guide = COPY_POINT(light1->pos);
 
-	while(guide[X] < light2->pos[X]){
-		plotPixel(
-				guide, rgbToInt(INTERPOLATE_COLOR(light1, light2, guide, X)));
-		guide[X]++;
+	int row = light1->pos[Y] + g_screenHeight / 2,
+		minColumn = (g_clipRect.minX > 0)?g_clipRect.minX:0,
+		maxColumn = (g_clipRect.maxX < g_screenWidth - 1)?
+			g_clipRect.maxX:g_screenWidth - 1;
+	if(row < 0 || g_screenHeight - 1 < row || row < g_clipRect.minY ||
+		g_clipRect.maxY < row)
+		return;
+
+	// the pixels are at start + step for every whole step that keeps them left
+	// of the line's end; each one's column is computed from the start of the
+	// line, as plotPixel() would, so that clipping doesn't change the rounding
+	Point_t start = light1->pos[X], length = light2->pos[X] - start,
+		halfWidth = g_screenWidth / 2,
+		first = fmax(floor(minColumn - halfWidth - start - 1), 0),
+		last = fmin(ceil(maxColumn - halfWidth - start + 1), ceil(length));
+	// past 2^52, adding a step to a double needn't change it
+	if(last < first || (double)(1LL << 52) < last)
+		return;
+	long long step = first, end = last;
+	while(step < end && (int)(start + step + halfWidth) < minColumn)
+		step++;
+	while(step < end && (start + (end - 1) >= light2->pos[X] ||
+		maxColumn < (int)(start + (end - 1) + halfWidth)))
+		end--;
+	while(start + end < light2->pos[X] &&
+		(int)(start + end + halfWidth) <= maxColumn)
+		end++;
+	if(step >= end)
+		return;
+
+	// each channel is stepped in ::SPAN_COLOR_BITS fixed point; its step is
+	// rounded toward zero, so that it can't overshoot the end's color, and
+	// its start is biased by ::SPAN_COLOR_BIAS, so that colors which are
+	// exactly whole aren't truncated to the one below. A span no longer than
+	// a pixel only draws its first, so it isn't stepped at all: dividing by
+	// its length could overflow.
+	int channel;
+	long long color[3], delta[3];
+	for(channel = 0; channel < 3; channel++){
+		delta[channel] = (length > 1)?
+			(light2->color[channel] - light1->color[channel]) *
+				(double)(1LL << SPAN_COLOR_BITS) / length:0;
+		color[channel] = ((long long)light1->color[channel] <<
+			SPAN_COLOR_BITS) + SPAN_COLOR_BIAS + step * delta[channel];
+	}
+
+	// the tiles the span crosses are brought up to date, and marked as
+	// changed, before it's drawn
+	int firstColumn = start + step + halfWidth,
+		lastColumn = start + (end - 1) + halfWidth, tileColumn;
+	for(tileColumn = firstColumn - firstColumn % DEPTH_TILE_SIZE;
+		tileColumn <= lastColumn; tileColumn += DEPTH_TILE_SIZE)
+		currentTile(g_zbuffer, tileColumn, row)->dirty = 1;
+
+	float depth = light1->pos[Z],
+		*depths = &g_zbuffer->depth[ZBUFFER_PIXEL(g_zbuffer, 0, row)];
+	uint32_t *colors = &g_zbuffer->color[ZBUFFER_PIXEL(g_zbuffer, 0, row)];
+	for(; step < end; step++){
+		int column = start + step + halfWidth;
+		if(depths[column] < depth){
+			if(depths[column] == ZBUFFER_EMPTY)
+				markFilled(g_zbuffer, column, row, 1);
+			depths[column] = depth;
+			colors[column] = (color[R] >> SPAN_COLOR_BITS << 16) |
+				(color[G] >> SPAN_COLOR_BITS << 8) |
+				(color[B] >> SPAN_COLOR_BITS);
+		}
+		color[R] += delta[R];
+		color[G] += delta[G];
+		color[B] += delta[B];
 	}
 }
 
 void scanlineRender(Light_t *l1, Light_t *l2, Light_t *l3){
-	Light_t **pts;
+	PixelRect_t bounds = triangleBounds(l1->pos, l2->pos, l3->pos);
+	if(!clipRect(&bounds))
+		return;
+
+	if(g_rasterizer == RASTERIZER_EDGE){
+		if(insideGuardBand(l1->pos) && insideGuardBand(l2->pos) &&
+			insideGuardBand(l3->pos))
+			edgeRender(l1, l2, l3);
+		else
+			guardBandRender(l1, l2, l3);
+		return;
+	}
+
+	if(g_depthCulling && hiddenTriangle(&bounds, l1, l2, l3))
+		return;
+
+	Light_t *pts[3];
 	l1->pos = COPY_POINT(l1->pos);
 	l2->pos = COPY_POINT(l2->pos);
 	l3->pos = COPY_POINT(l3->pos);
@@ -130,43 +401,61 @@ void scanlineRender(Light_t *l1, Light_t *l2, Light_t *l3){
 
 	if(l1->pos[Y] >= l2->pos[Y] && l1->pos[Y] >= l3->pos[Y]){
 		if(l3->pos[Y] > l2->pos[Y])
-			pts = (Light_t *[]){l1, l3, l2};
+			memcpy(pts, (Light_t *[]){l1, l3, l2}, sizeof(pts));
 		else
-			pts = (Light_t *[]){l1, l2, l3};
+			memcpy(pts, (Light_t *[]){l1, l2, l3}, sizeof(pts));
 	}
 
 	else if(l2->pos[Y] >= l1->pos[Y] && l2->pos[Y] >= l3->pos[Y]){
 		if(l3->pos[Y] > l1->pos[Y])
-			pts = (Light_t *[]){l2, l3, l1};
+			memcpy(pts, (Light_t *[]){l2, l3, l1}, sizeof(pts));
 		else
-			pts = (Light_t *[]){l2, l1, l3};
+			memcpy(pts, (Light_t *[]){l2, l1, l3}, sizeof(pts));
 	}
 
 	else {
 		if(l2->pos[Y] > l1->pos[Y])
-			pts = (Light_t *[]){l3, l2, l1};
+			memcpy(pts, (Light_t *[]){l3, l2, l1}, sizeof(pts));
 		else
-			pts = (Light_t *[]){l3, l1, l2};
+			memcpy(pts, (Light_t *[]){l3, l1, l2}, sizeof(pts));
 	}
 
-	double m1 = inverseSlope(pts[1]->pos, pts[2]->pos),
+	Point_t m1 = inverseSlope(pts[1]->pos, pts[2]->pos),
 		m2 = inverseSlope(pts[0]->pos, pts[1]->pos),
 		m3 = inverseSlope(pts[0]->pos, pts[2]->pos);
 
 	Point_t *shortGuide = COPY_POINT(pts[2]->pos),
 		*longGuide = COPY_POINT(pts[2]->pos);
+	RGB_t shortColor[3], longColor[3];
+
+	// the rows above the screen are skipped in one step, rather than walked,
+	// and those below it aren't reached; the skip doesn't depend on
+	// ::g_clipRect, so that clipped triangles are walked as unclipped ones
+	Point_t topRow = -(g_screenHeight / 2),
+		bottomRow = g_screenHeight - 1 - g_screenHeight / 2,
+		skip = fmin(topRow, pts[1]->pos[Y]) - shortGuide[Y];
+	if(skip > 0){
+		shortGuide[X] += skip * m1;
+		shortGuide[Y] += skip;
+		longGuide[X] += skip * m3;
+		longGuide[Y] += skip;
+	}
 
-	while(shortGuide[Y] < pts[1]->pos[Y]){
-		drawHorizontalGradientLine(
-			&(Light_t){
-				.pos = shortGuide,
-				.color = INTERPOLATE_COLOR(pts[2], pts[1], shortGuide, Y)
-			},
-			&(Light_t){
-				.pos = longGuide,
-				.color = INTERPOLATE_COLOR(pts[2], pts[0], longGuide, Y)
-			}
-		);
+	while(shortGuide[Y] < pts[1]->pos[Y] && shortGuide[Y] <= bottomRow){
+		if(VISIBLE_ROW(shortGuide)){
+			INTERPOLATE_COLOR(pts[2], pts[1], shortGuide, Y, shortColor);
+			INTERPOLATE_COLOR(pts[2], pts[0], longGuide, Y, longColor);
+			drawHorizontalGradientLine(
+				&(Light_t){
+					.pos = shortGuide,
+					.color = shortColor
+				},
+				&(Light_t){
+					.pos = longGuide,
+					.color = longColor
+				}
+			);
+		}
 
 		shortGuide[X] += m1;
 		shortGuide[Y]++;
@@ -176,18 +465,29 @@ void scanlineRender(Light_t *l1, Light_t *l2, Light_t *l3){
 	}
 
 	shortGuide = COPY_POINT(pts[1]->pos);
+	skip = fmin(topRow, pts[0]->pos[Y]) - shortGuide[Y];
+	if(skip > 0){
+		shortGuide[X] += skip * m2;
+		shortGuide[Y] += skip;
+		longGuide[X] += skip * m3;
+		longGuide[Y] += skip;
+	}
 
-	while(shortGuide[Y] < pts[0]->pos[Y]){
-		drawHorizontalGradientLine(
-			&(Light_t){
-				.pos = shortGuide,
-				.color = INTERPOLATE_COLOR(pts[1], pts[0], shortGuide, Y)
-			},
-			&(Light_t){
-				.pos = longGuide,
-				.color = INTERPOLATE_COLOR(pts[2], pts[0], longGuide, Y)
-			}
-		);
+	while(shortGuide[Y] < pts[0]->pos[Y] && shortGuide[Y] <= bottomRow){
+		if(VISIBLE_ROW(shortGuide)){
+			INTERPOLATE_COLOR(pts[1], pts[0], shortGuide, Y, shortColor);
+			INTERPOLATE_COLOR(pts[2], pts[0], longGuide, Y, longColor);
+			drawHorizontalGradientLine(
+				&(Light_t){
+					.pos = shortGuide,
+					.color = shortColor
+				},
+				&(Light_t){
+					.pos = longGuide,
+					.color = longColor
+				}
+			);
+		}
 
 		shortGuide[X] += m2;
 		shortGuide[Y]++;
@@ -197,7 +497,7 @@ void scanlineRender(Light_t *l1, Light_t *l2, Light_t *l3){
 	}
 }
 
-RGB_t *lightColor(Point_t *vertex, Point_t *surfaceNorm){
+void lightColor(Point_t *vertex, Point_t *surfaceNorm, RGB_t *color){
 	RGB_t *ambientLight = RGB(
 		0.2 * 0x00,
 		0.2 * 0x00,
@@ -209,8 +509,9 @@ RGB_t *lightColor(Point_t *vertex, Point_t *surfaceNorm){
 		.pos = POINT(0, 1000, 0, 0)
 	};
 
-	Point_t *dLightVector = NORMALIZE(SUB_POINT(vertex, diffuseSource.pos));
-	double diffuseDot = dotProduct(surfaceNorm, dLightVector);
+	Point_t *dLightVector = SUB_POINT(vertex, diffuseSource.pos);
+	NORMALIZE(dLightVector);
+	Point_t diffuseDot = dotProduct(surfaceNorm, dLightVector);
 
 	RGB_t *diffuseLight = (diffuseDot < 0)?RGB(0, 0, 0):RGB(
 		diffuseSource.color[R] * diffuseDot,
@@ -223,8 +524,9 @@ RGB_t *lightColor(Point_t *vertex, Point_t *surfaceNorm){
 		.pos = POINT(10, -100, 50, 0)
 	};
 	Point_t *view = POINT(0, 0, 1, 0);
-	Point_t *sLightVector = NORMALIZE(SUB_POINT(vertex, specularSource.pos));
-	double specularDot = pow(
+	Point_t *sLightVector = SUB_POINT(vertex, specularSource.pos);
+	NORMALIZE(sLightVector);
+	Point_t specularDot = mathPowInt(
 			dotProduct(view, sLightVector), SPECULAR_FADE_CONSTANT);
 	RGB_t *specularLight = (specularDot < 0)?RGB(0, 0, 0):RGB(
 		specularSource.color[R] * specularDot,
@@ -239,15 +541,12 @@ RGB_t *lightColor(Point_t *vertex, Point_t *surfaceNorm){
 		ambientLight[B] + diffuseLight[B] + specularLight[B]
 	};
 
-	RGB_t *resultColor = malloc(3 * sizeof(RGB_t));
 	int colorThird;
 	for(colorThird = 0; colorThird < 3; colorThird++){
 		if(0xFF < sum[colorThird])
 			sum[colorThird] = 0xFF;
-		resultColor[colorThird] = sum[colorThird];
+		color[colorThird] = sum[colorThird];
 	}
-
-	return resultColor;
 }
 
 static inline unsigned int rgbToInt(RGB_t *color){
@@ -257,7 +556,338 @@ static inline unsigned int rgbToInt(RGB_t *color){
 	return (color[R] << 4 * 4) + (color[G] << 4 * 2) + color[B];
 }
 
-static inline double inverseSlope(Point_t *p1, Point_t *p2){
-	double deltaY = p1[Y] - p2[Y];
+static inline Point_t inverseSlope(Point_t *p1, Point_t *p2){
+	Point_t deltaY = p1[Y] - p2[Y];
 	return (deltaY != 0)?(p1[X] - p2[X]) / (deltaY):0;
 }
+
+PixelRect_t triangleBounds(Point_t *p1, Point_t *p2, Point_t *p3){
+	// the rasterizers never stray more than a pixel from the vertices'
+	// bounding box; clamping first keeps the conversions to int defined
+	Point_t minX = fmin(p1[X], fmin(p2[X], p3[X])) + g_screenWidth / 2 - 1,
+		maxX = fmax(p1[X], fmax(p2[X], p3[X])) + g_screenWidth / 2 + 1,
+		minY = fmin(p1[Y], fmin(p2[Y], p3[Y])) + g_screenHeight / 2 - 1,
+		maxY = fmax(p1[Y], fmax(p2[Y], p3[Y])) + g_screenHeight / 2 + 1;
+	return (PixelRect_t){
+		.minX = floor(fmin(fmax(minX, -1), g_screenWidth)),
+		.minY = floor(fmin(fmax(minY, -1), g_screenHeight)),
+		.maxX = ceil(fmin(fmax(maxX, -1), g_screenWidth)),
+		.maxY = ceil(fmin(fmax(maxY, -1), g_screenHeight))
+	};
+}
+
+static void linePixel(const LineWalk_t *line, unsigned int steps, int *column,
+	int *row){
+	unsigned int diagonal = ((line->longDist >> 1) +
+		(unsigned long long)steps * line->shortDist) / line->longDist;
+	long long offsetX = (long long)diagonal * line->dx1 +
+			(long long)(steps - diagonal) * line->dx2,
+		offsetY = (long long)diagonal * line->dy1 +
+			(long long)(steps - diagonal) * line->dy2;
+	*column = line->x + offsetX + g_screenWidth / 2;
+	*row = line->y + offsetY + g_screenHeight / 2;
+}
+
+static int lineOutside(const LineWalk_t *line, const PixelRect_t *rect,
+	unsigned int steps, int entry){
+	int column, row;
+	linePixel(line, steps, &column, &row);
+	int rightward = line->dx1 > 0, downward = line->dy1 > 0;
+	if(entry)
+		return (rightward?column < rect->minX:column > rect->maxX) ||
+			(downward?row < rect->minY:row > rect->maxY);
+	return (rightward?column > rect->maxX:column < rect->minX) ||
+		(downward?row > rect->maxY:row < rect->minY);
+}
+
+static inline int insideGuardBand(const Point_t *pos){
+	return fabs(pos[X] + g_screenWidth / 2) < RASTER_MAX_COORDINATE &&
+		fabs(pos[Y] + g_screenHeight / 2) < RASTER_MAX_COORDINATE;
+}
+
+static void guardBandRender(Light_t *l1, Light_t *l2, Light_t *l3){
+	// a triangle clipped to a square has at most seven vertices
+	ClipVertex_t polygons[2][8];
+	Light_t *lights[3] = {l1, l2, l3};
+	int numVertices = 3, vertex, coord;
+	for(vertex = 0; vertex < 3; vertex++){
+		memcpy(polygons[0][vertex].pos, lights[vertex]->pos,
+			sizeof(polygons[0][vertex].pos));
+		for(coord = 0; coord < 3; coord++)
+			polygons[0][vertex].color[coord] = lights[vertex]->color[coord];
+	}
+
+	// Sutherland-Hodgman, against the guard band's left, right, top and bottom
+	Point_t limit = RASTER_MAX_COORDINATE - 1;
+	int side;
+	for(side = 0; side < 4; side++){
+		ClipVertex_t *polygon = polygons[side % 2],
+			*clipped = polygons[(side + 1) % 2];
+		int axis = (side < 2)?X:Y, numClipped = 0,
+			sign = (side % 2)?-1:1;
+		Point_t bound = sign * -limit - ((axis == X)?
+			g_screenWidth / 2:g_screenHeight / 2);
+
+		for(vertex = 0; vertex < numVertices; vertex++){
+			ClipVertex_t *from = &polygon[vertex],
+				*to = &polygon[(vertex + 1) % numVertices];
+			Point_t fromInside = sign * (from->pos[axis] - bound),
+				toInside = sign * (to->pos[axis] - bound);
+			if(fromInside >= 0)
+				clipped[numClipped++] = *from;
+			if((fromInside >= 0) != (toInside >= 0)){
+				Point_t t = fromInside / (fromInside - toInside);
+				ClipVertex_t *cut = &clipped[numClipped++];
+				for(coord = 0; coord < 4; coord++)
+					cut->pos[coord] = from->pos[coord] +
+						t * (to->pos[coord] - from->pos[coord]);
+				for(coord = 0; coord < 3; coord++)
+					cut->color[coord] = from->color[coord] +
+						t * (to->color[coord] - from->color[coord]);
+				cut->pos[axis] = bound;
+			}
+		}
+		numVertices = numClipped;
+	}
+
+	RGB_t colors[8][3];
+	for(vertex = 0; vertex < numVertices; vertex++)
+		for(coord = 0; coord < 3; coord++)
+			colors[vertex][coord] =
+				clampChannel(polygons[0][vertex].color[coord] + 0.5);
+	for(vertex = 1; vertex + 1 < numVertices; vertex++)
+		edgeRender(
+			&(Light_t){.color = colors[0], .pos = polygons[0][0].pos},
+			&(Light_t){.color = colors[vertex], .pos = polygons[0][vertex].pos},
+			&(Light_t){
+				.color = colors[vertex + 1],
+				.pos = polygons[0][vertex + 1].pos
+			}
+		);
+}
+
+static int hiddenTriangle(const PixelRect_t *bounds, Light_t *l1, Light_t *l2,
+	Light_t *l3){
+	// every pixel takes the depth of one of the vertices
+	g_depthStats.triangles++;
+	if(!hiddenRect(g_zbuffer, bounds,
+		fmax(l1->pos[Z], fmax(l2->pos[Z], l3->pos[Z]))))
+		return 0;
+
+	g_depthStats.trianglesRejected++;
+	g_depthStats.pixelsRejected += (long)(bounds->maxX - bounds->minX + 1) *
+		(bounds->maxY - bounds->minY + 1);
+	return 1;
+}
+
+static void edgeRender(Light_t *l1, Light_t *l2, Light_t *l3){
+	Light_t *vert[3] = {l1, l2, l3};
+	Point_t screenX[3], screenY[3];
+	long long fixedX[3], fixedY[3];
+	int ind;
+	for(ind = 0; ind < 3; ind++){
+		screenX[ind] = vert[ind]->pos[X] + g_screenWidth / 2;
+		screenY[ind] = vert[ind]->pos[Y] + g_screenHeight / 2;
+		if(!(fabs(screenX[ind]) < RASTER_MAX_COORDINATE &&
+			fabs(screenY[ind]) < RASTER_MAX_COORDINATE))
+			return;
+		fixedX[ind] = llrint(screenX[ind] * (1 << SUBPIXEL_BITS));
+		fixedY[ind] = llrint(screenY[ind] * (1 << SUBPIXEL_BITS));
+	}
+
+	long long area = (fixedX[1] - fixedX[0]) * (fixedY[2] - fixedY[0]) -
+		(fixedY[1] - fixedY[0]) * (fixedX[2] - fixedX[0]);
+	if(area == 0)
+		return;
+
+	// wind the vertices so that the interior's edge functions are positive
+	if(area < 0){
+		Light_t *tmpLight = vert[1];
+		vert[1] = vert[2];
+		vert[2] = tmpLight;
+		Point_t tmpScreen = screenX[1];
+		screenX[1] = screenX[2];
+		screenX[2] = tmpScreen;
+		tmpScreen = screenY[1];
+		screenY[1] = screenY[2];
+		screenY[2] = tmpScreen;
+		long long tmpFixed = fixedX[1];
+		fixedX[1] = fixedX[2];
+		fixedX[2] = tmpFixed;
+		tmpFixed = fixedY[1];
+		fixedY[1] = fixedY[2];
+		fixedY[2] = tmpFixed;
+	}
+
+	// the pixels whose centers lie within the triangle's bounding box
+	long long half = 1 << (SUBPIXEL_BITS - 1),
+		ceilBias = (1 << SUBPIXEL_BITS) - 1;
+	int minX = (FIXED_MIN(fixedX) - half + ceilBias) >> SUBPIXEL_BITS,
+		maxX = (FIXED_MAX(fixedX) - half) >> SUBPIXEL_BITS,
+		minY = (FIXED_MIN(fixedY) - half + ceilBias) >> SUBPIXEL_BITS,
+		maxY = (FIXED_MAX(fixedY) - half) >> SUBPIXEL_BITS;
+	minX = (minX < 0)?0:minX;
+	minY = (minY < 0)?0:minY;
+	maxX = (maxX > g_screenWidth - 1)?g_screenWidth - 1:maxX;
+	maxY = (maxY > g_screenHeight - 1)?g_screenHeight - 1:maxY;
+	minX = (minX < g_clipRect.minX)?g_clipRect.minX:minX;
+	minY = (minY < g_clipRect.minY)?g_clipRect.minY:minY;
+	maxX = (maxX > g_clipRect.maxX)?g_clipRect.maxX:maxX;
+	maxY = (maxY > g_clipRect.maxY)?g_clipRect.maxY:maxY;
+	if(maxX < minX || maxY < minY)
+		return;
+
+	// each edge function, E(x, y) = dx (y - y1) - dy (x - x1), at the center
+	// of pixel (minX, minY), and its change per pixel along either axis; the
+	// edges that aren't top or left edges are biased by -1, so that pixels
+	// exactly on them fail the E >= 0 test
+	long long origin[3], stepX[3], stepY[3];
+	long long centerX = ((long long)minX << SUBPIXEL_BITS) + half,
+		centerY = ((long long)minY << SUBPIXEL_BITS) + half;
+	int edge;
+	for(edge = 0; edge < 3; edge++){
+		int next = (edge + 1) % 3;
+		long long dx = fixedX[next] - fixedX[edge],
+			dy = fixedY[next] - fixedY[edge];
+		int topLeft = dy < 0 || (dy == 0 && dx > 0);
+		origin[edge] = dx * (centerY - fixedY[edge]) -
+			dy * (centerX - fixedX[edge]) - !topLeft;
+		stepX[edge] = -dy * (1 << SUBPIXEL_BITS);
+		stepY[edge] = dx * (1 << SUBPIXEL_BITS);
+	}
+
+	// the planes of depth, red, green, and blue over the screen
+	Point_t attr[4][3], gradX[4], gradY[4];
+	for(ind = 0; ind < 3; ind++){
+		attr[0][ind] = vert[ind]->pos[Z];
+		attr[1][ind] = vert[ind]->color[R];
+		attr[2][ind] = vert[ind]->color[G];
+		attr[3][ind] = vert[ind]->color[B];
+	}
+
+	Point_t x1 = screenX[1] - screenX[0], y1 = screenY[1] - screenY[0],
+		x2 = screenX[2] - screenX[0], y2 = screenY[2] - screenY[0],
+		invArea = 1 / (x1 * y2 - x2 * y1);
+	int plane;
+	for(plane = 0; plane < 4; plane++){
+		Point_t a1 = attr[plane][1] - attr[plane][0],
+			a2 = attr[plane][2] - attr[plane][0];
+		gradX[plane] = (a1 * y2 - a2 * y1) * invArea;
+		gradY[plane] = (a2 * x1 - a1 * x2) * invArea;
+	}
+
+	// the blocks are aligned to the screen, rather than to the bounding box, so
+	// that a clip rectangle aligned to them doesn't change any pixel's value
+	if(g_depthCulling){
+		PixelRect_t bounds = {minX, minY, maxX, maxY};
+		g_depthStats.triangles++;
+		if(hiddenRect(g_zbuffer, &bounds, planeMax(&bounds, attr[0][0],
+			minX + 0.5 - screenX[0], minY + 0.5 - screenY[0], gradX[0],
+			gradY[0]))){
+			g_depthStats.trianglesRejected++;
+			g_depthStats.pixelsRejected += (long)(maxX - minX + 1) *
+				(maxY - minY + 1);
+			return;
+		}
+	}
+
+	int blockX, blockY;
+	for(blockY = minY - minY % RASTER_BLOCK_SIZE; blockY <= maxY;
+		blockY += RASTER_BLOCK_SIZE){
+		int firstY = (blockY < minY)?minY:blockY,
+			lastY = blockY + RASTER_BLOCK_SIZE - 1;
+		lastY = (lastY > maxY)?maxY:lastY;
+
+		for(blockX = minX - minX % RASTER_BLOCK_SIZE; blockX <= maxX;
+			blockX += RASTER_BLOCK_SIZE){
+			int firstX = (blockX < minX)?minX:blockX,
+				lastX = blockX + RASTER_BLOCK_SIZE - 1;
+			lastX = (lastX > maxX)?maxX:lastX;
+
+			// skip blocks wholly outside an edge, and skip the per-pixel
+			// tests in blocks wholly inside all three
+			long long corner[3];
+			int reject = 0, accept = 1;
+			for(edge = 0; edge < 3; edge++){
+				corner[edge] = origin[edge] + (firstX - minX) * stepX[edge] +
+					(firstY - minY) * stepY[edge];
+				long long acrossX = (lastX - firstX) * stepX[edge],
+					acrossY = (lastY - firstY) * stepY[edge],
+					low = corner[edge] + ((acrossX < 0)?acrossX:0) +
+						((acrossY < 0)?acrossY:0),
+					high = corner[edge] + ((acrossX > 0)?acrossX:0) +
+						((acrossY > 0)?acrossY:0);
+				reject |= high < 0;
+				accept &= low >= 0;
+			}
+			if(reject)
+				continue;
+
+			// the blocks are the coarse depth's tiles
+			PixelRect_t block = {firstX, firstY, lastX, lastY};
+			if(g_depthCulling && hiddenRect(g_zbuffer, &block, planeMax(&block,
+				attr[0][0], firstX + 0.5 - screenX[0],
+				firstY + 0.5 - screenY[0], gradX[0], gradY[0]))){
+				g_depthStats.blocksRejected++;
+				g_depthStats.pixelsRejected += (lastX - firstX + 1) *
+					(lastY - firstY + 1);
+				continue;
+			}
+
+			DepthTile_t *tile = currentTile(g_zbuffer, firstX, firstY);
+			tile->dirty = 1;
+			int pixelX, pixelY, filled = 0;
+			for(pixelY = firstY; pixelY <= lastY; pixelY++){
+				long long edge0 = corner[0], edge1 = corner[1],
+					edge2 = corner[2];
+				Point_t value[4];
+				for(plane = 0; plane < 4; plane++)
+					value[plane] = attr[plane][0] +
+						gradX[plane] * (firstX + 0.5 - screenX[0]) +
+						gradY[plane] * (pixelY + 0.5 - screenY[0]);
+
+				float *depths = &g_zbuffer->depth[
+					ZBUFFER_PIXEL(g_zbuffer, 0, pixelY)];
+				uint32_t *colors = &g_zbuffer->color[
+					ZBUFFER_PIXEL(g_zbuffer, 0, pixelY)];
+				for(pixelX = firstX; pixelX <= lastX; pixelX++){
+					float depth = value[0];
+					if((accept || (edge0 | edge1 | edge2) >= 0) &&
+						depths[pixelX] < depth){
+						filled += depths[pixelX] == ZBUFFER_EMPTY;
+						depths[pixelX] = depth;
+						colors[pixelX] = (clampChannel(value[1]) << 4 * 4) +
+							(clampChannel(value[2]) << 4 * 2) +
+							clampChannel(value[3]);
+					}
+
+					edge0 += stepX[0];
+					edge1 += stepX[1];
+					edge2 += stepX[2];
+					for(plane = 0; plane < 4; plane++)
+						value[plane] += gradX[plane];
+				}
+
+				corner[0] += stepY[0];
+				corner[1] += stepY[1];
+				corner[2] += stepY[2];
+			}
+
+			tile->empty -= filled;
+		}
+	}
+}
+
+static inline Point_t planeMax(const PixelRect_t *rect, Point_t value,
+	Point_t fromX, Point_t fromY, Point_t gradX, Point_t gradY){
+	Point_t toX = gradX * fromX, toY = gradY * fromY,
+		acrossX = gradX * (rect->maxX - rect->minX),
+		acrossY = gradY * (rect->maxY - rect->minY);
+	return value + toX + toY + fmax(acrossX, 0) + fmax(acrossY, 0) +
+		DEPTH_ROUNDING * (fabs(value) + fabs(toX) + fabs(toY) +
+		fabs(acrossX) + fabs(acrossY));
+}
+
+static inline unsigned int clampChannel(Point_t value){
+	return (value < 0)?0:(value > 0xFF)?0xFF:(unsigned int)value;
+}
@@ -10,6 +10,7 @@
 #pragma once
 
 #include "src/graphics/matrix.h"
+#include "src/graphics/screen.h"
 
 /*
  * @brief Draw a line with the default color.
@@ -79,11 +80,34 @@ typedef struct {
 	Point_t *pos; // The light's location.
 } Light_t;
 
+#define RASTERIZER_SCANLINE 0 // ::scanlineRender() walks sorted scanlines.
+#define RASTERIZER_EDGE 1 // ::scanlineRender() evaluates edge functions.
+
+// The fractional bits of the edge rasterizer's fixed-point coordinates.
+#define SUBPIXEL_BITS 4
+
+// The width and height, in pixels, of the blocks the edge rasterizer walks;
+// they're the tiles of the z-buffer's coarse depth.
+#define RASTER_BLOCK_SIZE DEPTH_TILE_SIZE
+
+// The half-width, in pixels, of the edge rasterizer's guard band: a square
+// around the screen's corner that keeps its products in range. Triangles that
+// reach past it are clipped to it first; the rest are only clipped per pixel.
+#define RASTER_MAX_COORDINATE (1 << 20)
+
+//! The rasterizer behind ::scanlineRender(): ::RASTERIZER_SCANLINE or
+//! ::RASTERIZER_EDGE.
+extern int g_rasterizer;
+
 /*
  * @brief Draw a horizontal line with an interpolated color gradient.
  *
- * @param p1 The first endpoint.
- * @param p2 The second endpoint.
+ * The colors are stepped across the line in fixed point, so they may differ
+ * by one from an exact interpolation. Every pixel takes the depth of the
+ * leftmost endpoint.
+ *
+ * @param light1 The first endpoint.
+ * @param light2 The second endpoint.
 */
 void drawHorizontalGradientLine(Light_t *light1, Light_t *light2);
 
@@ -91,7 +115,9 @@ void drawHorizontalGradientLine(Light_t *light1, Light_t *light2);
  *  @brief Rasterize a line.
  *
  *  Rasterize a line with endpoints @a (p1[X], p1[Y]) and @a (p2[X], p2[Y])
- *  using the Bresenham algorithm.
+ *  using the Bresenham algorithm. Only the run of the line's pixels within
+ *  the screen and ::g_clipRect is walked; its first pixel and error term are
+ *  computed directly, so the pixels match those of the whole line.
  *
  *  @param p1 The first endpoint.
  *  @param p2 The second endpoint.
@@ -102,20 +128,42 @@ void (drawLine)(Point_t *p1, Point_t *p2, int color);
 /*
  * @brief Fill a triangle using scanline-rendering.
  *
+ * With ::g_rasterizer set to ::RASTERIZER_EDGE, the triangle is instead
+ * rasterized with integer edge functions, evaluated at pixel centers in
+ * blocks of ::RASTER_BLOCK_SIZE pixels and stepped incrementally, with depth
+ * and color interpolated across the whole triangle. A top-left fill rule
+ * covers each pixel along an edge shared by two triangles exactly once.
+ * Either way, only pixels within ::g_clipRect are written, and with
+ * ::g_depthCulling set, triangles (and the edge rasterizer's blocks) that the
+ * z-buffer's coarse depth shows to be hidden are skipped before shading.
+ * Triangles wholly off the screen are rejected before either rasterizer, the
+ * scanline rasterizer starts at the screen's first row, and the edge
+ * rasterizer clips triangles that leave its guard band; see
+ * ::RASTER_MAX_COORDINATE.
+ *
  * @param light1 The position and color of the first vertex of the triangle.
  * @param light2 The position and color of the second vertex of the triangle.
  * @param light3 The position and color of the third vertex of the triangle.
 */
 void scanlineRender(Light_t *light1, Light_t *light2, Light_t *light3);
 /*
- * @brief Calculate the color of a triangle with lighting applied..
+ * @brief Return the pixels that ::scanlineRender() might draw for a triangle.
+ *
+ * The bounds are conservative, and aren't clipped; coordinates far off-screen
+ * are clamped to just beyond the screen.
  *
  * @param p1 The first vertex of the triangle.
  * @param p2 The second vertex of the triangle.
  * @param p3 The third vertex of the triangle.
- * @param surfaceNorm The averaged surface normal of the triangle.
+*/
+PixelRect_t triangleBounds(Point_t *p1, Point_t *p2, Point_t *p3);
+
+/*
+ * @brief Calculate the color of a vertex with lighting applied.
  *
- * @return The RGB color of the triangle with ambient, diffuse, and spectral
- *      lighting applied.
+ * @param p1 The vertex.
+ * @param surfaceNorm The unit surface normal at @p p1.
+ * @param color Set to the RGB color of the vertex with ambient, diffuse, and
+ *      spectral lighting applied.
 */
-RGB_t *lightColor(Point_t *p1, Point_t *surfaceNorm);
+void lightColor(Point_t *p1, Point_t *surfaceNorm, RGB_t *color);
@@ -1,73 +1,76 @@
-#include <math.h>
+#include <tgmath.h>
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "src/globals.h"
+#include "src/graphics/camera.h"
+#include "src/graphics/cull.h"
 #include "src/graphics/geometry.h"
 #include "src/graphics/graphics.h"
 #include "src/graphics/matrix.h"
-
-/*
- * @brief Get a ::Point_t representation of a ::Matrix_t row.
- *
- * Values are taken from the first four columns of the matrix, because this
- * macro is only useful in the context of ::multiplyMatrix().
- *
- * @param matrix (::Matrix_t *) A matrix.
- * @param row (int) The row to retrieve values from.
-*/
-#define GET_HORIZONTAL_POINT(matrix, row) \
-	(POINT(matrix->points[0][row], matrix->points[1][row],\
-		matrix->points[2][row], matrix->points[3][row]))
-
-/*!
- *  The ratio between degrees and radians -- faciliates conversion from the
- *  former to the latter.
- */
-#define RAD (M_PI / 180)
-
-/*
- *  @brief Indicate whether or not a given triangle is visible to the camera.
- *
- *  Given the @f$(x, y, z)@f$ coordinates of the three vertices of a triangle,
- *  calculate the triangle's surface normal to determine whether it's visible
- *  to the camera.
- *
- *  @param p1 The first vertex.
- *  @param p2 The second vertex.
- *  @param p3 The third vertex.
- *
- *  @return 1 if the triangle specified by the three vertices is visible to
- *      the camera; 0 otherwise.
- */
-static int backfaceCull(Point_t *p1, Point_t *p2, Point_t *p3);
-
-/*
- * @brief Wrapper for ::surfaceNormal() that acts on a triangle.
- *
- * @param pts A matrix containing a triangular mesh.
- * @param vertex The first vertex of a triangle in @p pts.
- *
- * @return The surface normal of the triangle depicted by the ::Point_t * at
- *      offset @a vertex in @a pts->points, and the two ::Point_t * after it.
-*/
-static Point_t *triangleNormal(const Matrix_t *pts, int vertex);
+#include "src/graphics/tiles.h"
+#include "src/graphics/transform.h"
 
 Matrix_t * createMatrix(void){
 	Matrix_t * const matrix = malloc(sizeof(Matrix_t));
+	g_allocationStats.systemAllocations++;
 	matrix->numPoints = 0;
+	matrix->capacity = 0;
 
 	matrix->points = NULL;
+	matrix->arena = NULL;
+
+	return matrix;
+}
+
+Matrix_t * createArenaMatrix(Arena_t *arena){
+	Matrix_t * const matrix = arenaAlloc(arena, sizeof(Matrix_t));
+	matrix->numPoints = 0;
+	matrix->capacity = 0;
+
+	matrix->points = NULL;
+	matrix->arena = arena;
 
 	return matrix;
 }
 
 void expandMatrix(Matrix_t * const matrix){
+	if(matrix->numPoints == matrix->capacity)
+		reserveMatrix(matrix, matrix->numPoints + 1);
 	matrix->numPoints++;
-	matrix->points = realloc(matrix->points,
-		matrix->numPoints * sizeof(Point_t *));
+}
+
+void reserveMatrix(Matrix_t * const matrix, int numPoints){
+	if(numPoints <= matrix->capacity)
+		return;
+
+	int capacity = 2 * matrix->capacity;
+	if(capacity < MATRIX_MIN_CAPACITY)
+		capacity = MATRIX_MIN_CAPACITY;
+	if(capacity < numPoints)
+		capacity = numPoints;
+
+	void *points;
+	if(matrix->arena != NULL)
+		points = arenaAlloc(matrix->arena, capacity * sizeof(*matrix->points));
+	else {
+		if(posix_memalign(&points, MATRIX_ALIGNMENT,
+			capacity * sizeof(*matrix->points)))
+			FATAL("Failed to allocate %d points.", capacity);
+		g_allocationStats.systemAllocations++;
+	}
+
+	if(matrix->points != NULL){
+		memcpy(points, matrix->points,
+			matrix->numPoints * sizeof(*matrix->points));
+		if(matrix->arena == NULL)
+			free(matrix->points);
+	}
+
+	matrix->points = points;
+	matrix->capacity = capacity;
 }
 
 void freeMatrices(int numMatrices, ...){
@@ -81,9 +84,9 @@ void freeMatrices(int numMatrices, ...){
 }
 
 void freeMatrix(Matrix_t * matrix){
-	int pt;
-	for(pt = 0; pt < matrix->numPoints; pt++)
-		free(matrix->points[pt]);
+	if(matrix->arena != NULL)
+		return;
+
 	free(matrix->points);
 	free(matrix);
 }
@@ -93,133 +96,154 @@ void freeMatrixFromVoid(void * matrix){
 }
 
 void drawMatrix(const Matrix_t *matrix){
-	int vertex;
-	for(vertex = 0; vertex < matrix->numPoints; vertex += 3){
-		Point_t *p1 = matrix->points[vertex],
-			*p2 = matrix->points[vertex + 1],
-			*p3 = matrix->points[vertex + 2];
-
-		Point_t *norm = NORMALIZE(triangleNormal(matrix, vertex));
-		RGB_t *color1 = lightColor(p1, norm),
-			*color2 = lightColor(p2, norm),
-			*color3 = lightColor(p3, norm);
-
-		if(backfaceCull(p1, p2, p3))
-			scanlineRender(
-				&(Light_t){
-					.color = color1,
-					.pos = p1
-				},
-				&(Light_t){
-					.color = color2,
-					.pos = p2
-				},
-				&(Light_t){
-					.color = color3,
-					.pos = p3
-				}
-			);
-
-		free(norm);
-		free(color1);
-		free(color2);
-		free(color3);
+	Point_t (*points)[4] = matrix->points, (*screen)[4] = points;
+	int numTriangles = matrix->numPoints / 3, vertex;
+	if(g_camera.perspective){
+		screen = arenaAlloc(&g_frameArena,
+			3 * numTriangles * sizeof(*screen));
+		for(vertex = 0; vertex < 3 * numTriangles; vertex++)
+			projectPoint(&g_camera, points[vertex], screen[vertex]);
+	}
+
+	// every triangle is culled before any is lit
+	int *survivors = arenaAlloc(&g_frameArena,
+		numTriangles * sizeof(*survivors));
+	int numSurvivors = cullTriangles(screen, NULL, numTriangles, survivors),
+		survivor;
+
+	beginTiles();
+	for(survivor = 0; survivor < numSurvivors; survivor++){
+		vertex = 3 * survivors[survivor];
+		shadeTriangle(
+			(Point_t *[]){
+				points[vertex],
+				points[vertex + 1],
+				points[vertex + 2]
+			},
+			(Point_t *[]){
+				screen[vertex],
+				screen[vertex + 1],
+				screen[vertex + 2]
+			}
+		);
 	}
+	renderTiles();
+}
+
+void drawTriangle(Point_t *p1, Point_t *p2, Point_t *p3){
+	Point_t *world[3] = {p1, p2, p3}, *screen[3] = {p1, p2, p3};
+
+	// a perspective camera can only tell the triangle's facing once it's
+	// projected, and not at all if it crosses the near plane
+	Point_t projected[3][4];
+	int vertex, beyond = 1;
+	if(g_camera.perspective)
+		for(vertex = 0; vertex < 3; vertex++){
+			beyond &= projectPoint(&g_camera, world[vertex],
+				projected[vertex]);
+			screen[vertex] = projected[vertex];
+		}
+
+	if(beyond && !backfaceCull(screen[0], screen[1], screen[2]))
+		return;
+	shadeTriangle(world, screen);
+}
+
+void shadeTriangle(Point_t **world, Point_t **screen){
+	Point_t norm[4];
+	surfaceNormal(world[0], world[1], world[2], norm);
+	NORMALIZE(norm);
+
+	RGB_t color1[3], color2[3], color3[3];
+	lightColor(world[0], norm, color1);
+	lightColor(world[1], norm, color2);
+	lightColor(world[2], norm, color3);
+
+	// a projected vertex has a w of 0 if it's short of the near plane
+	if(g_camera.perspective &&
+		!(screen[0][W] && screen[1][W] && screen[2][W]))
+		submitViewTriangle(&g_camera,
+			&(Light_t){
+				.color = color1,
+				.pos = world[0]
+			},
+			&(Light_t){
+				.color = color2,
+				.pos = world[1]
+			},
+			&(Light_t){
+				.color = color3,
+				.pos = world[2]
+			}
+		);
+	else
+		submitTriangle(
+			&(Light_t){
+				.color = color1,
+				.pos = screen[0]
+			},
+			&(Light_t){
+				.color = color2,
+				.pos = screen[1]
+			},
+			&(Light_t){
+				.color = color3,
+				.pos = screen[2]
+			}
+		);
 }
 
 void multiplyScalar(double scalar, Matrix_t * const matrix){
-	int row, col;
-	for(row = 0; row < 4; row++)
-		for(col = 0; col < matrix->numPoints; col++)
-			matrix->points[row][col] *= scalar;
+	int point, coord;
+	for(point = 0; point < matrix->numPoints; point++)
+		for(coord = 0; coord < 4; coord++)
+			matrix->points[point][coord] *= scalar;
 }
 
 void multiplyMatrices(int numMatrices, ...){
+	// a lone matrix has nothing to be multiplied into it
+	if(numMatrices < 2)
+		return;
+
 	va_list matrices;
 	va_start(matrices, numMatrices);
 
-	Matrix_t **multiplicands = malloc((numMatrices - 1) * sizeof(Matrix_t *));
+	Mat4_t chain[numMatrices - 1];
 
 	int arg;
 	for(arg = 0; arg < numMatrices - 1; arg++)
-		multiplicands[arg] = va_arg(matrices, Matrix_t *);
+		chain[arg] = mat4FromMatrix(va_arg(matrices, Matrix_t *));
 
 	// last matrix, into which all preceding matrices will be multiplied
 	Matrix_t * points = va_arg(matrices, Matrix_t *);
 	va_end(matrices);
 
-	for(arg = 0; arg < numMatrices - 1; arg++)
-		multiplyMatrix(multiplicands[arg], points);
-	free(multiplicands);
+	applyMat4Chain(numMatrices - 1, chain, points);
 }
 
 void multiplyMatrix(Matrix_t * const m1, Matrix_t * const m2){
-	int col;
-	for(col = 0; col < m2->numPoints; col++){
-
-		double dot0 = dotProduct(GET_HORIZONTAL_POINT(m1, 0), m2->points[col]);
-		double dot1 = dotProduct(GET_HORIZONTAL_POINT(m1, 1), m2->points[col]);
-		double dot2 = dotProduct(GET_HORIZONTAL_POINT(m1, 2), m2->points[col]);
-		double dot3 = dotProduct(GET_HORIZONTAL_POINT(m1, 3), m2->points[col]);
-
-		m2->points[col][X] = dot0;
-		m2->points[col][Y] = dot1;
-		m2->points[col][Z] = dot2;
-		m2->points[col][W] = dot3;
-	}
+	Mat4_t transform = mat4FromMatrix(m1);
+	applyMat4(&transform, m2);
 }
 
 Matrix_t * createIdentity(void){
-	Matrix_t * identity = createMatrix();
-	addPoint(identity, POINT(1, 0, 0, 0));
-	addPoint(identity, POINT(0, 1, 0, 0));
-	addPoint(identity, POINT(0, 0, 1, 0));
-	addPoint(identity, POINT(0, 0, 0, 1));
-	return identity;
+	Mat4_t identity = identityMat4();
+	return matrixFromMat4(&identity);
 }
 
 Matrix_t * createTranslation(Point_t *delta){
-	Matrix_t * translation = createIdentity();
-	translation->points[W][X] = delta[X];
-	translation->points[W][Y] = delta[Y];
-	translation->points[W][Z] = delta[Z];
-	return translation;
+	Mat4_t translation = translationMat4(delta);
+	return matrixFromMat4(&translation);
 }
 
 Matrix_t * createScale(Point_t *delta){
-	Matrix_t * scale = createMatrix();
-	addPoint(scale, POINT(delta[X], 0, 0, 0));
-	addPoint(scale, POINT(0, delta[Y], 0, 0));
-	addPoint(scale, POINT(0, 0, delta[Z], 0));
-	addPoint(scale, POINT(0, 0, 0, 1));
-	return scale;
+	Mat4_t scale = scaleMat4(delta);
+	return matrixFromMat4(&scale);
 }
 
 Matrix_t * createRotation(int axis, double angle){
-	Matrix_t * rotation = createMatrix();
-
-	double radAngle = angle * RAD;
-	double sinA = sin(radAngle), cosA = cos(radAngle);
-	if(axis == X_AXIS){
-		addPoint(rotation, POINT(1, 0, 0, 0));
-		addPoint(rotation, POINT(0, cosA, sinA, 0));
-		addPoint(rotation, POINT(0, -sinA, cosA, 0));
-	}
-
-	else if(axis == Y_AXIS){
-		addPoint(rotation, POINT(cosA, 0, sinA, 0));
-		addPoint(rotation, POINT(0, 1, 0, 0));
-		addPoint(rotation, POINT(-sinA, 0, cosA, 0));
-	}
-
-	else if(axis == Z_AXIS){
-		addPoint(rotation, POINT(cosA, sinA, 0, 0));
-		addPoint(rotation, POINT(-sinA, cosA, 0, 0));
-		addPoint(rotation, POINT(0, 0, 1, 0));
-	}
-
-	addPoint(rotation, POINT(0, 0, 0, 1));
-	return rotation;
+	Mat4_t rotation = rotationMat4(axis, angle);
+	return matrixFromMat4(&rotation);
 }
 
 void printPointMatrix(const Matrix_t * const matrix){
@@ -248,25 +272,23 @@ int equalMatrix(Matrix_t * m1, Matrix_t * m2){
 	if(m1->numPoints != m2->numPoints)
 		return 0;
 
-	int point;
+	int point, coord;
 	for(point = 0; point < m1->numPoints; point++)
-		if((int)m1->points[point][X] != (int)m2->points[point][X] ||
-			(int)m1->points[point][Y] != (int)m2->points[point][Y] ||
-			(int)m1->points[point][Z] != (int)m2->points[point][Z] ||
-			(int)m1->points[point][W] != (int)m2->points[point][W])
-			return 0;
+		for(coord = 0; coord < 4; coord++)
+			if(abs((int)m1->points[point][coord] -
+				(int)m2->points[point][coord]) > EQUALITY_TOLERANCE)
+				return 0;
 
 	return 1;
 }
 
 Matrix_t * copyMatrix(const Matrix_t * const matrix){
 	Matrix_t * copyMatrix = createMatrix();
+	reserveMatrix(copyMatrix, matrix->numPoints);
 
-	int point;
-	for(point = 0; point < matrix->numPoints; point++)
-		addPoint(copyMatrix, POINT(matrix->points[point][X],
-			matrix->points[point][Y], matrix->points[point][Z],
-			matrix->points[point][W]));
+	memcpy(copyMatrix->points, matrix->points,
+		matrix->numPoints * sizeof(*matrix->points));
+	copyMatrix->numPoints = matrix->numPoints;
 
 	return copyMatrix;
 }
@@ -287,6 +309,7 @@ Matrix_t * readPointsFromFile(char * filename){
 	int numPoints;
 	if(fscanf(file, "%d:", &numPoints) < 1)
 		FATAL("Reading %s. Failed to read number of points.", fullFilename);
+	reserveMatrix(points, numPoints);
 
 	// read points from file; add them to the points matrix
 	int point;
@@ -324,28 +347,25 @@ void writePointsToFile(Matrix_t * points, char * filename){
 	fclose(file);
 }
 
-double dotProduct(Point_t *p1, Point_t *p2){
+Point_t dotProduct(Point_t *p1, Point_t *p2){
 	return p1[X] * p2[X] + p1[Y] * p2[Y] + p1[Z] * p2[Z] + p1[W] * p2[W];
 }
 
-Point_t *surfaceNormal(Point_t *p1, Point_t *p2, Point_t *p3){
+void surfaceNormal(Point_t *p1, Point_t *p2, Point_t *p3, Point_t *normal){
 	Point_t *u = SUB_POINT(p2, p1),
 		*v = SUB_POINT(p3, p1);
 
-	return createPoint(POINT(
-			(u[Y] * v[Z]) - (u[Z] * v[Y]),
-			(u[Z] * v[X]) - (u[X] * v[Z]),
-			(u[X] * v[Y]) - (u[Y] * v[X]), 0));
+	normal[X] = (u[Y] * v[Z]) - (u[Z] * v[Y]);
+	normal[Y] = (u[Z] * v[X]) - (u[X] * v[Z]);
+	normal[Z] = (u[X] * v[Y]) - (u[Y] * v[X]);
+	normal[W] = 0;
 }
 
-static int backfaceCull(Point_t *p1, Point_t *p2, Point_t *p3){
-	Point_t *norm = surfaceNormal(p1, p2, p3);
-	int culled = -(int)norm[Z] < 0;
-	free(norm);
-	return culled;
+int backfaceCull(Point_t *p1, Point_t *p2, Point_t *p3){
+	Point_t normZ = (p2[X] - p1[X]) * (p3[Y] - p1[Y]) -
+		(p2[Y] - p1[Y]) * (p3[X] - p1[X]);
+	// compared as a double, not truncated to an int, which projected
+	// triangles near the eye overflow
+	return normZ >= 1;
 }
 
-static Point_t *triangleNormal(const Matrix_t *pts, int vertex){
-	return surfaceNormal(pts->points[vertex], pts->points[vertex + 1],
-			pts->points[vertex + 2]);
-}
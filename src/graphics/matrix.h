@@ -8,34 +8,40 @@
 
 #pragma once
 
-#include <math.h>
+#include <tgmath.h>
 
-#define CLEAR(matrix_pointer) \
-	do {\
-		freeMatrix(matrix_pointer);\
-		matrix_pointer = createMatrix();\
-	} while(0)
+#include "src/arena.h"
+#include "src/fast_math.h"
+
+/*
+ * @brief Remove every point from a ::Matrix_t.
+ *
+ * The matrix's storage is kept, so refilling it doesn't reallocate.
+ *
+ * @param matrix_pointer (::Matrix_t *) The matrix to empty.
+ */
+#define CLEAR(matrix_pointer) ((matrix_pointer)->numPoints = 0)
 
 /*
  * @brief Create a point with a specific w-coordinate.
  *
  * @params See ::createPoint().
 */
-#define POINT4(x, y, z, w) ((double []){x, y, z, w})
+#define POINT4(x, y, z, w) ((Point_t []){x, y, z, w})
 
 /*
  * @brief Create a point with a w-coordinate of 1.
  *
  * @params See ::createPoint().
 */
-#define POINT3(x, y, z) ((double []){x, y, z, 1})
+#define POINT3(x, y, z) ((Point_t []){x, y, z, 1})
 
 /*
  * @brief Create a point with no z or w coordinate.
  *
  * @params See ::createPoint().
 */
-#define POINT2(x, y) ((double []){x, y, 0, 1})
+#define POINT2(x, y) ((Point_t []){x, y, 0, 1})
 
 /*
  *  @brief Helper macro for the overloaded ::POINT().
@@ -54,7 +60,7 @@
 	func_name
 
 /*
- *  @brief Overloaded double array constructor.
+ *  @brief Overloaded ::Point_t array constructor.
  *
  *  Uses ::CREATE_POINT_VA_MACRO() to select an appropriate function-like macro
  *  wrapper for the number of arguments (2, 3, or 4).
@@ -72,16 +78,28 @@
 /*
  * @brief Normalize a vector.
  *
+ * With ::g_fastMath set, multiplies by ::fastInvSqrt() instead of dividing
+ * by the exact length.
+ *
  * @param vector (::Point_t *) A vector.
 */
 #define NORMALIZE(vector) \
 	({\
 		Point_t *vec = vector;\
-		double length = sqrt(vec[X] * vec[X] + vec[Y] * vec[Y] +\
-			vec[Z] * vec[Z]);\
-		vec[X] /= length;\
-		vec[Y] /= length;\
-		vec[Z] /= length;\
+		Point_t lengthSquared = vec[X] * vec[X] + vec[Y] * vec[Y] +\
+			vec[Z] * vec[Z];\
+		if(g_fastMath){\
+			Point_t inverse = fastInvSqrt(lengthSquared);\
+			vec[X] *= inverse;\
+			vec[Y] *= inverse;\
+			vec[Z] *= inverse;\
+		}\
+		else {\
+			Point_t length = sqrt(lengthSquared);\
+			vec[X] /= length;\
+			vec[Y] /= length;\
+			vec[Z] /= length;\
+		}\
 		vec;\
 	})
 
@@ -114,6 +132,18 @@
 */
 #define COPY_POINT(pt) (POINT(pt[X], pt[Y], pt[Z], pt[W]))
 
+/*
+ * The largest difference between two truncated coordinates that
+ * ::equalMatrix() still considers equal. Single-precision builds are checked
+ * against the double-precision test fixtures, so they're allowed to differ by
+ * one unit of rounding.
+ */
+#ifdef SINGLE_PRECISION
+#define EQUALITY_TOLERANCE 1
+#else
+#define EQUALITY_TOLERANCE 0
+#endif
+
 #define X_AXIS 0 // The x-axis.
 #define Y_AXIS 1 // The y-axis.
 #define Z_AXIS 2 // The z-axis.
@@ -122,20 +152,42 @@
 #define Z 2 // The index of the x-coordinate of a point in ::Point_t *.
 #define W 3 // The index of the w-coordinate of a point in ::Point_t *.
 
+// The byte alignment of ::Matrix_t::points, wide enough for any vector load.
+#define MATRIX_ALIGNMENT 32
+
+// The number of points a ::Matrix_t first reserves room for.
+#define MATRIX_MIN_CAPACITY 16
+
+/*
+ * The scalar type of every coordinate, depth and interpolant in the render
+ * pipeline: double by default, or float if compiled with SINGLE_PRECISION
+ * (`make all PRECISION=float`).
+ */
+#ifdef SINGLE_PRECISION
+typedef float Point_t; // Used to represent multi-dimensional points.
+#else
 typedef double Point_t; // Used to represent multi-dimensional points.
+#endif
 
-// A struct to contain point coordinates.
+/*
+ * A struct to contain point coordinates.
+ *
+ * All points are stored back-to-back in a single aligned buffer of
+ * (x, y, z, w) quadruplets, which grows geometrically as points are added.
+ */
 typedef struct Matrix {
-	Point_t **points; // An pointer to an array of ::Point_t.
+	Point_t (*points)[4]; // A contiguous array of (x, y, z, w) points.
 	int numPoints; // The number of points in this ::Matrix_t.
+	int capacity; // The number of points ::Matrix_t::points has room for.
+	Arena_t *arena; // The arena ::Matrix_t::points lives in; NULL for the heap.
 } Matrix_t;
 
 /*
- * @brief Return an allocated ::Point_t.
+ * @brief Return a copy of a ::Point_t allocated in ::g_frameArena.
  *
  * @param Point_t The ::Point_t to create an allocated copy of.
  *
- * @return A pointer to the new ::Point_t.
+ * @return A pointer to the new ::Point_t, valid until the end of the frame.
 */
 Point_t *createPoint(Point_t *pt);
 
@@ -154,16 +206,42 @@ void addPoint(Matrix_t *const matrix, Point_t *point);
  */
 Matrix_t *createMatrix(void);
 
+/*!
+ *  @brief Create a ::Matrix_t whose storage lives in an ::Arena_t.
+ *
+ *  The matrix is released when @p arena is reset; ::freeMatrix() on it does
+ *  nothing.
+ *
+ *  @param arena The arena to allocate the matrix and its points from.
+ *
+ *  @return A pointer to the new ::Matrix_t.
+ */
+Matrix_t *createArenaMatrix(Arena_t *arena);
+
 /*!
  *  @brief Expand a ::Matrix_t::points to accomodate an additional point.
  *
- *  Realloc a given ::Matrix_t::points, and increment ::Matrix_t::numPoints.
+ *  Grow a given ::Matrix_t::points if it's full, and increment
+ *  ::Matrix_t::numPoints.
  *
  *  @param matrix The ::Matrix_t whose ::Matrix_t::points matrix will be
  *      expanded to an additional column
  */
 void expandMatrix(Matrix_t * const matrix);
 
+/*!
+ *  @brief Ensure that a ::Matrix_t has room for a number of points.
+ *
+ *  If ::Matrix_t::capacity is smaller than @p numPoints, reallocate
+ *  ::Matrix_t::points to hold at least @p numPoints points (and no fewer than
+ *  twice its old capacity, so that repeated calls stay linear). Existing points
+ *  are preserved, and ::Matrix_t::numPoints is left untouched.
+ *
+ *  @param matrix The ::Matrix_t to reserve room in.
+ *  @param numPoints The total number of points @p matrix must be able to hold.
+ */
+void reserveMatrix(Matrix_t *const matrix, int numPoints);
+
 /*!
  *  @brief ::freeMatrix() for varargs ::Matrix_t.
  *
@@ -199,11 +277,41 @@ void freeMatrixFromVoid(void *matrix);
  *  Draw @p matrix by rendering triangles for every triplet of points. The first
  *  three points of ::Matrix_t::points are the three vertices of the first
  *  triangle, the second three points are the vertices of the second, etc.
+ *  The whole batch is passed through ::cullTriangles() first, and only the
+ *  survivors are lit, with ::shadeTriangle(). With ::g_renderThreads greater
+ *  than 1, the lit triangles are binned into screen tiles and rasterized in
+ *  parallel; see tiles.h.
  *
  *  @param matrix The ::Matrix_t to be rendered.
  */
 void drawMatrix(const Matrix_t *matrix);
 
+/*!
+ *  @brief Light and render a single triangle.
+ *
+ *  The triangle is skipped if it faces away from the viewer; otherwise, it's
+ *  passed to ::shadeTriangle(). No memory is allocated, except to grow the
+ *  bins of a tiled frame.
+ *
+ *  @param p1 The first vertex of the triangle.
+ *  @param p2 The second vertex of the triangle.
+ *  @param p3 The third vertex of the triangle.
+ */
+void drawTriangle(Point_t *p1, Point_t *p2, Point_t *p3);
+
+/*!
+ *  @brief Light a triangle that has survived culling, and render it.
+ *
+ *  The triangle is lit with its surface normal, and passed to
+ *  ::submitTriangle(), or to ::submitViewTriangle() if it crosses the near
+ *  plane of a perspective ::g_camera.
+ *
+ *  @param world The triangle's three vertices, in world coordinates.
+ *  @param screen The same vertices, as projected through ::g_camera; the same
+ *      points as @p world for an orthographic camera.
+ */
+void shadeTriangle(Point_t **world, Point_t **screen);
+
 /*!
  *  @brief Multiply a ::Matrix_t by a scalar value.
  *
@@ -215,12 +323,13 @@ void multiplyScalar(double scalar, Matrix_t *const matrix);
 /*!
  *  @brief Multiply varargs matrices into the last one.
  *
- *  Call ::multiplyMatrix() for each of the first @f$numMatrices - 1@f$
- *  ::Matrix_t and the last ::Matrix_t; in short, multiply every argument
- *  ::Matrix_t before the last, into the last.
+ *  Multiply every argument ::Matrix_t before the last, into the last, as if
+ *  ::multiplyMatrix() were called with each in turn. The @a 4x4 matrices are
+ *  composed first, so the last ::Matrix_t's points are only traversed once.
+ *  A lone ::Matrix_t is left as it is.
  *
  *  @param numArgs The number of argument ::Matrix_t.
- *  @param ... More than one ::Matrix_t.
+ *  @param ... One or more ::Matrix_t.
  */
 void multiplyMatrices(int numMatrices, ...);
 
@@ -343,15 +452,31 @@ void writePointsToFile(Matrix_t *points, char *filename);
  *
  *  @return The dot-product of @p p1 and @p p2.
  */
-double dotProduct(Point_t *p1, Point_t *p2);
+Point_t dotProduct(Point_t *p1, Point_t *p2);
 
 /*
- * @brief Return the normal vector to a triangle.
+ * @brief Calculate the normal vector to a triangle.
  *
  * @param p1 The first vertex of the triangle.
  * @param p2 The second vertex of the triangle.
  * @param p3 The third vertex of the triangle.
- *
- * @return The surface normal of the triangle in ::Point_t form.
+ * @param normal Set to the (unnormalized) surface normal of the triangle, with
+ *      a w-coordinate of 0.
 */
-Point_t *surfaceNormal(Point_t *p1, Point_t *p2, Point_t *p3);
+void surfaceNormal(Point_t *p1, Point_t *p2, Point_t *p3, Point_t *normal);
+
+/*!
+ *  @brief Indicate whether or not a given triangle is visible to the camera.
+ *
+ *  Given the @f$(x, y, z)@f$ coordinates of the three vertices of a triangle,
+ *  calculate the z-coordinate of the triangle's surface normal to determine
+ *  whether it's visible to the camera.
+ *
+ *  @param p1 The first vertex.
+ *  @param p2 The second vertex.
+ *  @param p3 The third vertex.
+ *
+ *  @return 1 if the triangle specified by the three vertices is visible to
+ *      the camera; 0 otherwise.
+ */
+int backfaceCull(Point_t *p1, Point_t *p2, Point_t *p3);
@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tgmath.h>
+
+#include "src/arena.h"
+#include "src/globals.h"
+#include "src/graphics/camera.h"
+#include "src/graphics/cull.h"
+#include "src/graphics/graphics.h"
+#include "src/graphics/matrix.h"
+#include "src/graphics/mesh.h"
+#include "src/graphics/tiles.h"
+#include "src/graphics/transform.h"
+
+/*
+ * @brief Indicate whether a ::Mesh_t vertex has a normal.
+ *
+ * @param normal (Point_t *) The vertex's entry in ::Mesh_t::normals.
+ */
+#define HAS_NORMAL(normal) \
+	((normal)[X] != 0 || (normal)[Y] != 0 || (normal)[Z] != 0)
+
+Mesh_t *createMesh(void){
+	Mesh_t *mesh = malloc(sizeof(Mesh_t));
+	g_allocationStats.systemAllocations++;
+	mesh->vertices = createMatrix();
+	mesh->normals = createMatrix();
+	mesh->indices = NULL;
+	mesh->numIndices = 0;
+	mesh->capacity = 0;
+	return mesh;
+}
+
+void clearMesh(Mesh_t *const mesh){
+	mesh->vertices->numPoints = 0;
+	mesh->normals->numPoints = 0;
+	mesh->numIndices = 0;
+}
+
+void freeMesh(Mesh_t *mesh){
+	freeMatrices(2, mesh->vertices, mesh->normals);
+	free(mesh->indices);
+	free(mesh);
+}
+
+void reserveMesh(Mesh_t *const mesh, int numTriangles){
+	int numIndices = 3 * numTriangles;
+	if(numIndices <= mesh->capacity)
+		return;
+
+	int capacity = 2 * mesh->capacity;
+	if(capacity < 3 * MESH_MIN_CAPACITY)
+		capacity = 3 * MESH_MIN_CAPACITY;
+	if(capacity < numIndices)
+		capacity = numIndices;
+
+	int *indices = realloc(mesh->indices, capacity * sizeof(int));
+	if(indices == NULL)
+		FATAL("Failed to allocate %d mesh indices.", capacity);
+	g_allocationStats.systemAllocations++;
+
+	mesh->indices = indices;
+	mesh->capacity = capacity;
+}
+
+int addMeshVertex(Mesh_t *const mesh, Point_t *point){
+	addPoint(mesh->vertices, point);
+	addPoint(mesh->normals, POINT(0, 0, 0, 0));
+	return mesh->vertices->numPoints - 1;
+}
+
+int addMeshVertices(Mesh_t *const mesh, const Matrix_t *points,
+	const Matrix_t *normals){
+	int first = mesh->vertices->numPoints,
+		numVertices = first + points->numPoints;
+
+	reserveMatrix(mesh->vertices, numVertices);
+	memcpy(mesh->vertices->points[first], points->points,
+		points->numPoints * sizeof(*points->points));
+	mesh->vertices->numPoints = numVertices;
+
+	reserveMatrix(mesh->normals, numVertices);
+	if(normals != NULL)
+		memcpy(mesh->normals->points[first], normals->points,
+			points->numPoints * sizeof(*normals->points));
+	else
+		memset(mesh->normals->points[first], 0,
+			points->numPoints * sizeof(*mesh->normals->points));
+	mesh->normals->numPoints = numVertices;
+
+	return first;
+}
+
+void addTranslatedMesh(Mesh_t *const mesh, const Mesh_t *source,
+	Point_t *offset){
+	int first = addMeshVertices(mesh, source->vertices, source->normals);
+
+	int vertex;
+	for(vertex = first; vertex < mesh->vertices->numPoints; vertex++){
+		Point_t *point = mesh->vertices->points[vertex];
+		point[X] += offset[X];
+		point[Y] += offset[Y];
+		point[Z] += offset[Z];
+	}
+
+	reserveMesh(mesh, (mesh->numIndices + source->numIndices) / 3);
+	int index;
+	for(index = 0; index < source->numIndices; index++)
+		mesh->indices[mesh->numIndices++] = first + source->indices[index];
+}
+
+void addMeshTriangle(Mesh_t *const mesh, int v1, int v2, int v3){
+	reserveMesh(mesh, mesh->numIndices / 3 + 1);
+	mesh->indices[mesh->numIndices++] = v1;
+	mesh->indices[mesh->numIndices++] = v2;
+	mesh->indices[mesh->numIndices++] = v3;
+}
+
+void addMesh(Matrix_t *const points, const Mesh_t *mesh){
+	int first = points->numPoints;
+	reserveMatrix(points, first + mesh->numIndices);
+
+	int index;
+	for(index = 0; index < mesh->numIndices; index++)
+		memcpy(points->points[first + index],
+			mesh->vertices->points[mesh->indices[index]],
+			sizeof(*points->points));
+	points->numPoints += mesh->numIndices;
+}
+
+void transformMesh(const Mat4_t *transform, Mesh_t *const mesh){
+	applyMat4(transform, mesh->vertices);
+
+	Mat4_t normalTransform;
+	if(!normalMat4(transform, &normalTransform))
+		return;
+	applyMat4(&normalTransform, mesh->normals);
+
+	int vertex;
+	for(vertex = 0; vertex < mesh->normals->numPoints; vertex++){
+		Point_t *normal = mesh->normals->points[vertex];
+		if(!HAS_NORMAL(normal))
+			continue;
+
+		Point_t length = sqrt(dotProduct(normal, normal));
+		normal[X] /= length;
+		normal[Y] /= length;
+		normal[Z] /= length;
+	}
+}
+
+void drawMesh(const Mesh_t *mesh){
+	Point_t (*vertices)[4] = mesh->vertices->points,
+		(*normals)[4] = mesh->normals->points;
+	int numVertices = mesh->vertices->numPoints,
+		numTriangles = mesh->numIndices / 3, vertex;
+
+	// vertices are lit where they are, and drawn where they're projected
+	Point_t (*screen)[4] = vertices;
+	if(g_camera.perspective){
+		screen = arenaAlloc(&g_frameArena, numVertices * sizeof(*screen));
+		for(vertex = 0; vertex < numVertices; vertex++)
+			projectPoint(&g_camera, vertices[vertex], screen[vertex]);
+	}
+
+	int *survivors = arenaAlloc(&g_frameArena,
+		numTriangles * sizeof(*survivors));
+	int numSurvivors = cullTriangles(screen, mesh->indices, numTriangles,
+		survivors), survivor, corner;
+
+	// only the vertices of surviving triangles are lit
+	RGB_t (*colors)[3] = arenaAlloc(&g_frameArena,
+		numVertices * sizeof(*colors));
+	unsigned char *lit = arenaAlloc(&g_frameArena, numVertices);
+	memset(lit, 0, numVertices);
+	for(survivor = 0; survivor < numSurvivors; survivor++)
+		for(corner = 0; corner < 3; corner++){
+			vertex = mesh->indices[3 * survivors[survivor] + corner];
+			if(!lit[vertex] && HAS_NORMAL(normals[vertex])){
+				lightColor(vertices[vertex], normals[vertex], colors[vertex]);
+				lit[vertex] = 1;
+			}
+		}
+
+	beginTiles();
+	for(survivor = 0; survivor < numSurvivors; survivor++){
+		int *triangle = &mesh->indices[3 * survivors[survivor]],
+			v1 = triangle[0],
+			v2 = triangle[1],
+			v3 = triangle[2];
+
+		if(!HAS_NORMAL(normals[v1]) || !HAS_NORMAL(normals[v2]) ||
+			!HAS_NORMAL(normals[v3]))
+			shadeTriangle(
+				(Point_t *[]){vertices[v1], vertices[v2], vertices[v3]},
+				(Point_t *[]){screen[v1], screen[v2], screen[v3]}
+			);
+
+		// a projected vertex has a w of 0 if it's short of the near plane
+		else if(g_camera.perspective &&
+			!(screen[v1][W] && screen[v2][W] && screen[v3][W]))
+			submitViewTriangle(&g_camera,
+				&(Light_t){
+					.color = colors[v1],
+					.pos = vertices[v1]
+				},
+				&(Light_t){
+					.color = colors[v2],
+					.pos = vertices[v2]
+				},
+				&(Light_t){
+					.color = colors[v3],
+					.pos = vertices[v3]
+				}
+			);
+
+		else
+			submitTriangle(
+				&(Light_t){
+					.color = colors[v1],
+					.pos = screen[v1]
+				},
+				&(Light_t){
+					.color = colors[v2],
+					.pos = screen[v2]
+				},
+				&(Light_t){
+					.color = colors[v3],
+					.pos = screen[v3]
+				}
+			);
+	}
+	renderTiles();
+}
@@ -0,0 +1,138 @@
+/*!
+ *  @file
+ *  @brief An indexed triangle mesh.
+ *
+ *  A ::Mesh_t stores every unique vertex once, and describes its triangles
+ *  with offsets into that vertex array; transformations therefore cost one
+ *  vertex-multiplication per unique vertex, rather than one per triangle
+ *  corner, as with a triangle-list ::Matrix_t.
+ *
+ *  Vertices may carry a normal, in which case they're lit once per
+ *  ::drawMesh(), and their colors are shared by every triangle that meets
+ *  there; vertices without one are lit per triangle, with its face normal.
+ */
+
+#pragma once
+
+#include "src/graphics/matrix.h"
+#include "src/graphics/transform.h"
+
+// The number of triangles a ::Mesh_t first reserves room for.
+#define MESH_MIN_CAPACITY 16
+
+//! An indexed triangle mesh.
+typedef struct {
+	Matrix_t *vertices; //! The mesh's unique vertices.
+	Matrix_t *normals; //! A unit normal per vertex, or (0, 0, 0) for none.
+	int *indices; //! Three offsets into ::vertices per triangle.
+	int numIndices; //! The number of used ::indices.
+	int capacity; //! The number of indices ::indices has room for.
+} Mesh_t;
+
+/*!
+ *  @brief Allocate an empty ::Mesh_t.
+ *
+ *  @return A pointer to the new ::Mesh_t.
+ */
+Mesh_t *createMesh(void);
+
+/*!
+ *  @brief Remove every vertex and triangle from a ::Mesh_t.
+ *
+ *  @param mesh The mesh to empty; its storage is kept for reuse.
+ */
+void clearMesh(Mesh_t *const mesh);
+
+/*!
+ *  @brief Deallocate a ::Mesh_t.
+ *
+ *  @param mesh The mesh to deallocate.
+ */
+void freeMesh(Mesh_t *mesh);
+
+/*!
+ *  @brief Ensure a ::Mesh_t has room for a number of triangles.
+ *
+ *  @param mesh The mesh to expand.
+ *  @param numTriangles The total number of triangles @p mesh must hold.
+ */
+void reserveMesh(Mesh_t *const mesh, int numTriangles);
+
+/*!
+ *  @brief Add a vertex, without a normal, to a ::Mesh_t.
+ *
+ *  @param mesh The mesh to add the vertex to.
+ *  @param point The vertex.
+ *
+ *  @return The index of the new vertex.
+ */
+int addMeshVertex(Mesh_t *const mesh, Point_t *point);
+
+/*!
+ *  @brief Add every point of a ::Matrix_t to a ::Mesh_t as a vertex.
+ *
+ *  @param mesh The mesh to add the vertices to.
+ *  @param points The vertices to add.
+ *  @param normals The unit normals of @p points, one per point; NULL if the
+ *      vertices have none.
+ *
+ *  @return The index of the first added vertex; the rest follow it in order.
+ */
+int addMeshVertices(Mesh_t *const mesh, const Matrix_t *points,
+	const Matrix_t *normals);
+
+/*!
+ *  @brief Add a translated copy of a ::Mesh_t to another.
+ *
+ *  @param mesh The mesh to add the copy to.
+ *  @param source The mesh to copy; its normals are copied unchanged.
+ *  @param offset The translation applied to the copied vertices.
+ */
+void addTranslatedMesh(Mesh_t *const mesh, const Mesh_t *source,
+	Point_t *offset);
+
+/*!
+ *  @brief Add a triangle to a ::Mesh_t.
+ *
+ *  @param mesh The mesh to add the triangle to.
+ *  @param v1 The index of the triangle's first vertex.
+ *  @param v2 The index of the triangle's second vertex.
+ *  @param v3 The index of the triangle's third vertex.
+ */
+void addMeshTriangle(Mesh_t *const mesh, int v1, int v2, int v3);
+
+/*!
+ *  @brief Add the triangles of a ::Mesh_t to a ::Matrix_t.
+ *
+ *  Each triangle's three vertices are copied into @p points, in the
+ *  triangle-list layout expected by ::drawMatrix().
+ *
+ *  @param points The ::Matrix_t to add the triangles to.
+ *  @param mesh The mesh to expand.
+ */
+void addMesh(Matrix_t *const points, const Mesh_t *mesh);
+
+/*!
+ *  @brief Apply a transformation to a ::Mesh_t's vertices and normals.
+ *
+ *  Normals are carried along with ::normalMat4(), and renormalized.
+ *
+ *  @param transform The transformation to apply.
+ *  @param mesh The mesh to transform (in place).
+ */
+void transformMesh(const Mat4_t *transform, Mesh_t *const mesh);
+
+/*!
+ *  @brief Render a ::Mesh_t by drawing its triangles.
+ *
+ *  Vertices are projected through ::g_camera once each, and the triangles
+ *  are passed through ::cullTriangles(). Every vertex of a surviving triangle
+ *  that has a normal is then lit exactly once, in world coordinates, and
+ *  triangles whose three vertices all have normals are shaded with their
+ *  colors; other triangles are drawn with ::shadeTriangle(), with their face
+ *  normals.
+ *  Like ::drawMatrix(), rasterizes on ::g_renderThreads threads.
+ *
+ *  @param mesh The mesh to render.
+ */
+void drawMesh(const Mesh_t *mesh);
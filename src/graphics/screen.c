@@ -1,6 +1,9 @@
+#include <limits.h>
+#include <math.h>
 #include <SDL.h>
 #include <X11/Xlib.h>
 
+#include "src/arena.h"
 #include "src/globals.h"
 #include "src/graphics/screen.h"
 #include "src/graphics/matrix.h"
@@ -12,16 +15,30 @@
 int g_screenWidth, // the width of ::g_screen
 	g_screenHeight; // the height of ::g_screen
 static SDL_Surface *g_screen; // The engine's SDL screen.
+static int g_sharedScreen; // Whether ::g_zbuffer's color plane is
+	// ::g_screen's memory; if not, changes are copied to it as they're shown.
 ZBuffer_t *g_zbuffer = NULL; // The screen's z-buffer.
+_Thread_local PixelRect_t g_clipRect = {0, 0, INT_MAX, INT_MAX};
+int g_depthCulling = 1;
+_Thread_local DepthStats_t g_depthStats;
 
 /*
- * @brief Draw a pixel on the SDL screen.
+ * @brief Recompute a tile's ::DepthTile_t::farthest.
  *
- * @param x The x-coordinate of the pixel.
- * @param y The y-coordinate of the pixel.
- * @param color The color of the pixel.
+ * @param zBuf The buffer that holds the tile.
+ * @param column The tile's column.
+ * @param row The tile's row.
 */
-static inline void drawPixel(int x, int y, int color);
+static void refreshTile(ZBuffer_t *zBuf, int column, int row);
+
+/*
+ * @brief Copy rectangles of ::g_zbuffer's color plane to the SDL screen,
+ *      converting them to its pixel format.
+ *
+ * @param rects The rectangles to copy.
+ * @param numRects The number of @p rects.
+*/
+static void copyToScreen(const PixelRect_t *rects, int numRects);
 
 void configureScreen(void){
 	Display *display = XOpenDisplay(NULL);
@@ -33,9 +50,25 @@ void configureScreen(void){
 	if((SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) == -1))
 		FATAL("Could not initialize SDL: %s.\n", SDL_GetError());
 	g_screen = SDL_SetVideoMode(g_screenWidth, g_screenHeight, 32, SDL_SWSURFACE);
+	if(g_screen == NULL)
+		FATAL("Could not set the SDL video mode: %s.", SDL_GetError());
 	SDL_WM_SetCaption(SCREEN_NAME, NULL);
 
-	g_zbuffer = createZBuffer();
+	// the z-buffer draws straight into the screen if its pixels are laid out
+	// like the color plane, and it needn't be locked
+	SDL_PixelFormat *format = g_screen->format;
+	g_sharedScreen = !SDL_MUSTLOCK(g_screen) &&
+		g_screen->pitch % sizeof(uint32_t) == 0 &&
+		matchesColorPlane(format->BytesPerPixel, format->Rmask, format->Gmask,
+			format->Bmask);
+	g_zbuffer = g_sharedScreen?createZBufferOn(g_screen->pixels,
+		g_screen->pitch / sizeof(uint32_t)):createZBuffer();
+}
+
+int matchesColorPlane(int bytesPerPixel, uint32_t redMask, uint32_t greenMask,
+	uint32_t blueMask){
+	return bytesPerPixel == sizeof(uint32_t) && redMask == 0xFF0000 &&
+		greenMask == 0xFF00 && blueMask == 0xFF;
 }
 
 void (plotPixel)(Point_t *pt, int color){
@@ -43,19 +76,31 @@ void (plotPixel)(Point_t *pt, int color){
 		y = pt[Y] + g_screenHeight / 2;
 
 	if(!(x < 0 || g_screenWidth - 1 < x || y < 0 || g_screenHeight - 1 < y) &&
-		(g_zbuffer->buf[y][x][1] == -1 || g_zbuffer->buf[y][x][0] < pt[Z])){
-		g_zbuffer->buf[y][x][0] = pt[Z];
-		g_zbuffer->buf[y][x][1] = color;
-	}
+		!(x < g_clipRect.minX || g_clipRect.maxX < x || y < g_clipRect.minY ||
+			g_clipRect.maxY < y))
+		writePixel(g_zbuffer, x, y, pt[Z], color);
 }
 
 void renderScreen(void){
-	int y, x;
-	for(y = 0; y < g_screenHeight; y++)
-		for(x = 0; x < g_screenWidth; x++)
-			drawPixel(x, y,
-					g_zbuffer->buf[y][x][1] == -1?0x0:g_zbuffer->buf[y][x][1]);
-	SDL_Flip(g_screen);
+	// empty pixels are black, so the color plane is displayed as it is, or
+	// copied over as it is if it isn't the screen's memory
+	int numTiles = g_zbuffer->tileColumns *
+		((g_screenHeight + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE);
+	PixelRect_t *dirty = arenaAlloc(&g_frameArena,
+		numTiles * sizeof(PixelRect_t));
+	int numRects = takeDirtyRects(g_zbuffer, dirty);
+	if(numRects == 0)
+		return;
+	if(!g_sharedScreen)
+		copyToScreen(dirty, numRects);
+
+	SDL_Rect *rects = arenaAlloc(&g_frameArena, numRects * sizeof(SDL_Rect));
+	int rect;
+	for(rect = 0; rect < numRects; rect++)
+		rects[rect] = (SDL_Rect){dirty[rect].minX, dirty[rect].minY,
+			dirty[rect].maxX - dirty[rect].minX + 1,
+			dirty[rect].maxY - dirty[rect].minY + 1};
+	SDL_UpdateRects(g_screen, numRects, rects);
 }
 
 void clearScreen(void){
@@ -70,47 +115,176 @@ void quitScreen(void){
 }
 
 int writeScreen(const char * const filename){
+	renderScreen();
 	return SDL_SaveBMP(g_screen, filename);
 }
 
 ZBuffer_t *createZBuffer(void){
+	return createZBufferOn(NULL, g_screenWidth);
+}
+
+ZBuffer_t *createZBufferOn(uint32_t *color, int width){
 	ZBuffer_t *zBuf = malloc(sizeof(ZBuffer_t));
-	zBuf->buf = malloc(g_screenHeight * sizeof(double *));
+	size_t numPixels = (size_t)width * g_screenHeight;
+	zBuf->color = color;
+	zBuf->sharedColor = color != NULL;
+	if(posix_memalign((void **)&zBuf->depth, ZBUFFER_ALIGNMENT,
+			numPixels * sizeof(*zBuf->depth)) ||
+		(!zBuf->sharedColor && posix_memalign((void **)&zBuf->color,
+			ZBUFFER_ALIGNMENT, numPixels * sizeof(*zBuf->color))))
+		FATAL("Failed to allocate a %dx%d z-buffer.", g_screenWidth,
+			g_screenHeight);
+	zBuf->width = width;
 
-	int y;
-	for(y = 0; y < g_screenHeight; y++){
-		zBuf->buf[y] = malloc(g_screenWidth * sizeof(double *));
-		int x;
-		for(x = 0; x < g_screenWidth; x++){
-			zBuf->buf[y][x] = malloc(2 * sizeof(double));
-			zBuf->buf[y][x][0] = 0;
-			zBuf->buf[y][x][1] = -1;
-		}
-	}
+	zBuf->tileColumns = (g_screenWidth + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE;
+	zBuf->tiles = malloc(zBuf->tileColumns *
+		((g_screenHeight + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE) *
+		sizeof(DepthTile_t));
+	zBuf->generation = 0;
+
+	// the planes start out empty, so that no tile needs emptying as it's
+	// first used
+	size_t pixel;
+	for(pixel = 0; pixel < numPixels; pixel++)
+		zBuf->depth[pixel] = ZBUFFER_EMPTY;
+	memset(zBuf->color, 0, numPixels * sizeof(*zBuf->color));
 
+	int row, column;
+	for(row = 0; row * DEPTH_TILE_SIZE < g_screenHeight; row++)
+		for(column = 0; column < zBuf->tileColumns; column++){
+			DepthTile_t *tile = &zBuf->tiles[row * zBuf->tileColumns + column];
+			int width = g_screenWidth - column * DEPTH_TILE_SIZE,
+				height = g_screenHeight - row * DEPTH_TILE_SIZE;
+			tile->pixels = ((width < DEPTH_TILE_SIZE)?width:DEPTH_TILE_SIZE) *
+				((height < DEPTH_TILE_SIZE)?height:DEPTH_TILE_SIZE);
+			tile->empty = tile->pixels;
+			tile->misses = 0;
+			tile->farthest = ZBUFFER_EMPTY;
+			tile->generation = zBuf->generation;
+			tile->dirty = 0;
+		}
 	return zBuf;
 }
 
 void freeZBuffer(ZBuffer_t *zBuf){
-	int y;
-	for(y = 0; y < g_screenHeight; y++){
-		int x;
-		for(x = 0; x < g_screenWidth; x++)
-			free(zBuf->buf[y][x]);
-		free(zBuf->buf[y]);
-	}
-
-	free(zBuf->buf);
+	free(zBuf->depth);
+	if(!zBuf->sharedColor)
+		free(zBuf->color);
+	free(zBuf->tiles);
 	free(zBuf);
 }
 
 void clearZBuffer(ZBuffer_t *zBuf){
-	int y, x;
-	for(y = 0; y < g_screenHeight; y++)
-		for(x = 0; x < g_screenWidth; x++){
-			zBuf->buf[y][x][0] = 0;
-			zBuf->buf[y][x][1] = -1;
+	// once the count wraps around, a tile left alone for every generation
+	// since would pass for current, so each is emptied now instead
+	if(++zBuf->generation == 0){
+		int numTiles = zBuf->tileColumns *
+			((g_screenHeight + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE), tile;
+		for(tile = 0; tile < numTiles; tile++)
+			emptyTile(zBuf, &zBuf->tiles[tile]);
+	}
+}
+
+int takeDirtyRects(ZBuffer_t *zBuf, PixelRect_t *rects){
+	// each tile is flushed as it's reached
+	int numRects = 0, row, column;
+	for(row = 0; row * DEPTH_TILE_SIZE < g_screenHeight; row++)
+		for(column = 0; column < zBuf->tileColumns; column++){
+			DepthTile_t *tile = currentTile(zBuf, column * DEPTH_TILE_SIZE,
+				row * DEPTH_TILE_SIZE);
+			if(!tile->dirty)
+				continue;
+			tile->dirty = 0;
+
+			PixelRect_t rect = {column * DEPTH_TILE_SIZE, row * DEPTH_TILE_SIZE,
+				(column + 1) * DEPTH_TILE_SIZE - 1,
+				(row + 1) * DEPTH_TILE_SIZE - 1};
+			rect.maxX = (rect.maxX > g_screenWidth - 1)?
+				g_screenWidth - 1:rect.maxX;
+			rect.maxY = (rect.maxY > g_screenHeight - 1)?
+				g_screenHeight - 1:rect.maxY;
+
+			// extends the last rectangle if it's the tile to the left
+			if(numRects > 0 && rects[numRects - 1].minY == rect.minY &&
+				rects[numRects - 1].maxX + 1 == rect.minX)
+				rects[numRects - 1].maxX = rect.maxX;
+			else
+				rects[numRects++] = rect;
 		}
+
+	return numRects;
+}
+
+void flushZBuffer(ZBuffer_t *zBuf){
+	int row, column;
+	for(row = 0; row * DEPTH_TILE_SIZE < g_screenHeight; row++)
+		for(column = 0; column < zBuf->tileColumns; column++)
+			currentTile(zBuf, column * DEPTH_TILE_SIZE, row * DEPTH_TILE_SIZE);
+}
+
+void emptyTile(ZBuffer_t *zBuf, DepthTile_t *tile){
+	if(tile->empty < tile->pixels){
+		int index = tile - zBuf->tiles,
+			minX = index % zBuf->tileColumns * DEPTH_TILE_SIZE,
+			minY = index / zBuf->tileColumns * DEPTH_TILE_SIZE,
+			maxX = minX + DEPTH_TILE_SIZE, maxY = minY + DEPTH_TILE_SIZE;
+		maxX = (maxX > g_screenWidth)?g_screenWidth:maxX;
+		maxY = (maxY > g_screenHeight)?g_screenHeight:maxY;
+
+		int y, x;
+		for(y = minY; y < maxY; y++){
+			float *depth = &zBuf->depth[ZBUFFER_PIXEL(zBuf, 0, y)];
+			uint32_t *color = &zBuf->color[ZBUFFER_PIXEL(zBuf, 0, y)];
+			for(x = minX; x < maxX; x++){
+				depth[x] = ZBUFFER_EMPTY;
+				color[x] = 0;
+			}
+		}
+		tile->dirty = 1;
+	}
+
+	tile->empty = tile->pixels;
+	tile->misses = 0;
+	tile->farthest = ZBUFFER_EMPTY;
+	tile->generation = zBuf->generation;
+}
+
+int clipRect(PixelRect_t *rect){
+	rect->minX = (rect->minX < 0)?0:rect->minX;
+	rect->minY = (rect->minY < 0)?0:rect->minY;
+	rect->maxX = (rect->maxX > g_screenWidth - 1)?g_screenWidth - 1:rect->maxX;
+	rect->maxY = (rect->maxY > g_screenHeight - 1)?
+		g_screenHeight - 1:rect->maxY;
+	rect->minX = (rect->minX < g_clipRect.minX)?g_clipRect.minX:rect->minX;
+	rect->minY = (rect->minY < g_clipRect.minY)?g_clipRect.minY:rect->minY;
+	rect->maxX = (rect->maxX > g_clipRect.maxX)?g_clipRect.maxX:rect->maxX;
+	rect->maxY = (rect->maxY > g_clipRect.maxY)?g_clipRect.maxY:rect->maxY;
+	return rect->minX <= rect->maxX && rect->minY <= rect->maxY;
+}
+
+int hiddenRect(ZBuffer_t *zBuf, const PixelRect_t *rect, Point_t nearest){
+	int row, column;
+	for(row = rect->minY / DEPTH_TILE_SIZE;
+		row <= rect->maxY / DEPTH_TILE_SIZE; row++)
+		for(column = rect->minX / DEPTH_TILE_SIZE;
+			column <= rect->maxX / DEPTH_TILE_SIZE; column++){
+			// a stale tile is empty, and is left for the rasterizer to empty
+			DepthTile_t *tile = &zBuf->tiles[row * zBuf->tileColumns + column];
+			if(tile->generation != zBuf->generation || tile->empty > 0)
+				return 0;
+
+			// a stale bound is still a bound, since drawing only brings
+			// pixels nearer, so it's only recomputed now and then
+			if(!(nearest <= tile->farthest) &&
+				(++tile->misses >= DEPTH_TILE_REFRESH ||
+				tile->farthest == ZBUFFER_EMPTY))
+				refreshTile(zBuf, column, row);
+
+			if(!(nearest <= tile->farthest))
+				return 0;
+		}
+
+	return 1;
 }
 
 ZBuffer_t *readZBufferFromFile(const char *filePath){
@@ -130,11 +304,20 @@ ZBuffer_t *readZBufferFromFile(const char *filePath){
 
 	int y, x;
 	for(y = 0; y < g_screenHeight; y++)
-		for(x = 0; x < g_screenWidth; x++)
-			if(fscanf(file, "%lf,%lf,", &zBuf->buf[y][x][0],
-				&zBuf->buf[y][x][1]) < 2)
+		for(x = 0; x < g_screenWidth; x++){
+			double depth, color;
+			if(fscanf(file, "%lf,%lf,", &depth, &color) < 2)
 				FATAL("Reading '%s'. Failed to read pixel (%d, %d).",
 					fullFilePath, x, y);
+			if(color != -1){
+				int pixel = ZBUFFER_PIXEL(zBuf, x, y);
+				DepthTile_t *tile = currentTile(zBuf, x, y);
+				zBuf->depth[pixel] = depth;
+				zBuf->color[pixel] = color;
+				tile->empty--;
+				tile->dirty = 1;
+			}
+		}
 
 	fclose(file);
 	free(fullFilePath);
@@ -148,29 +331,99 @@ void writeZBufferToFile(ZBuffer_t *zBuf, const char *filePath){
 	FILE *file = fopen(fullFilePath, "w");
 	free(fullFilePath);
 
+	flushZBuffer(zBuf);
 	fprintf(file, "%d, %d:", g_screenWidth, g_screenHeight);
 	int y, x;
 	for(y = 0; y < g_screenHeight; y++)
-		for(x = 0; x < g_screenWidth; x++)
-			fprintf(
-					file, "%d,%d,", (int)zBuf->buf[y][x][0],
-					(int)zBuf->buf[y][x][1]);
+		for(x = 0; x < g_screenWidth; x++){
+			int pixel = ZBUFFER_PIXEL(zBuf, x, y);
+			if(zBuf->depth[pixel] == ZBUFFER_EMPTY)
+				fputs("0,-1,", file);
+			else
+				fprintf(file, "%d,%d,", (int)zBuf->depth[pixel],
+					(int)zBuf->color[pixel]);
+		}
 
 	fclose(file);
 }
 
 int equalZBuffers(ZBuffer_t *zBuf1, ZBuffer_t *zBuf2){
+	int covered = 0, mismatched = 0;
+	flushZBuffer(zBuf1);
+	flushZBuffer(zBuf2);
+
 	int y, x;
 	for(y = 0; y < g_screenHeight; y++)
-		for(x = 0; x < g_screenWidth; x++)
-			if((int)zBuf1->buf[y][x][0] != (int)zBuf2->buf[y][x][0] ||
-				(int)zBuf1->buf[y][x][1] != (int)zBuf2->buf[y][x][1])
-				return 0;
-	return 1;
+		for(x = 0; x < g_screenWidth; x++){
+			int pixel1 = ZBUFFER_PIXEL(zBuf1, x, y),
+				pixel2 = ZBUFFER_PIXEL(zBuf2, x, y);
+			int empty1 = zBuf1->depth[pixel1] == ZBUFFER_EMPTY,
+				empty2 = zBuf2->depth[pixel2] == ZBUFFER_EMPTY;
+			if(empty1 && empty2)
+				continue;
+			covered++;
+
+			int color1 = zBuf1->color[pixel1], color2 = zBuf2->color[pixel2];
+			if(empty1 || empty2 ||
+				abs((int)zBuf1->depth[pixel1] - (int)zBuf2->depth[pixel2]) >
+					ZBUFFER_DEPTH_TOLERANCE){
+				mismatched++;
+				continue;
+			}
+
+			int shift;
+			for(shift = 0; shift < 24; shift += 8)
+				if(abs(((color1 >> shift) & 0xFF) - ((color2 >> shift) & 0xFF)) >
+					ZBUFFER_COLOR_TOLERANCE){
+					mismatched++;
+					break;
+				}
+		}
+
+	return mismatched <= covered * ZBUFFER_MISMATCH_TOLERANCE;
 }
 
-static inline void drawPixel(int x, int y, int color){
-	Uint8 * pixelAddress = (Uint8 *)g_screen->pixels + y * g_screen->pitch +
-		x * g_screen->format->BytesPerPixel;
-	*(Uint32 *)pixelAddress = color;
-};
+static void copyToScreen(const PixelRect_t *rects, int numRects){
+	if(SDL_MUSTLOCK(g_screen) && SDL_LockSurface(g_screen) < 0)
+		FATAL("Could not lock the SDL screen: %s.", SDL_GetError());
+
+	int bytesPerPixel = g_screen->format->BytesPerPixel, rect, y, x;
+	for(rect = 0; rect < numRects; rect++)
+		for(y = rects[rect].minY; y <= rects[rect].maxY; y++){
+			uint32_t *row = &g_zbuffer->color[ZBUFFER_PIXEL(g_zbuffer, 0, y)];
+			Uint8 *pixels = (Uint8 *)g_screen->pixels + y * g_screen->pitch;
+			for(x = rects[rect].minX; x <= rects[rect].maxX; x++){
+				Uint32 pixel = SDL_MapRGB(g_screen->format, row[x] >> 16 & 0xFF,
+					row[x] >> 8 & 0xFF, row[x] & 0xFF);
+				// the pixel's low-order bytes, in the screen's byte order
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+				memcpy(pixels + x * bytesPerPixel, (Uint8 *)&pixel +
+					sizeof(pixel) - bytesPerPixel, bytesPerPixel);
+#else
+				memcpy(pixels + x * bytesPerPixel, &pixel, bytesPerPixel);
+#endif
+			}
+		}
+
+	if(SDL_MUSTLOCK(g_screen))
+		SDL_UnlockSurface(g_screen);
+}
+
+static void refreshTile(ZBuffer_t *zBuf, int column, int row){
+	DepthTile_t *tile = &zBuf->tiles[row * zBuf->tileColumns + column];
+	int maxX = (column + 1) * DEPTH_TILE_SIZE,
+		maxY = (row + 1) * DEPTH_TILE_SIZE;
+	maxX = (maxX > g_screenWidth)?g_screenWidth:maxX;
+	maxY = (maxY > g_screenHeight)?g_screenHeight:maxY;
+
+	float farthest = FLT_MAX;
+	int y, x;
+	for(y = row * DEPTH_TILE_SIZE; y < maxY; y++){
+		float *depth = &zBuf->depth[ZBUFFER_PIXEL(zBuf, 0, y)];
+		for(x = column * DEPTH_TILE_SIZE; x < maxX; x++)
+			farthest = (depth[x] < farthest)?depth[x]:farthest;
+	}
+
+	tile->farthest = farthest;
+	tile->misses = 0;
+}
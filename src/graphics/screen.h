@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <float.h>
+#include <stdint.h>
+
 #include "src/globals.h"
 #include "src/graphics/matrix.h"
 
@@ -52,15 +55,235 @@
 #define plotPixel(...) \
 	DRAW_PIXEL_VA_MACRO(__VA_ARGS__, plotPixel2, plotPixel1)(__VA_ARGS__)
 
+/*
+ * How far ::equalZBuffers() lets two pixels' colors differ, per channel, and
+ * what fraction of covered pixels may differ outright; see
+ * ::EQUALITY_TOLERANCE. Double-precision builds must match the fixtures
+ * exactly.
+ */
+#ifdef SINGLE_PRECISION
+#define ZBUFFER_COLOR_TOLERANCE 8
+#define ZBUFFER_MISMATCH_TOLERANCE 0.005
+#else
+#define ZBUFFER_COLOR_TOLERANCE 0
+#define ZBUFFER_MISMATCH_TOLERANCE 0
+#endif
+
+// How far ::equalZBuffers() lets two pixels' truncated depths differ. As with
+// ::EQUALITY_TOLERANCE, single-precision builds' depths may truncate to one
+// less or more than those of the double-precision test fixtures.
+#ifdef SINGLE_PRECISION
+#define ZBUFFER_DEPTH_TOLERANCE 1
+#else
+#define ZBUFFER_DEPTH_TOLERANCE 0
+#endif
+
+// The width and height, in pixels, of the tiles of a ::ZBuffer_t's coarse
+// depth; the edge rasterizer's blocks are aligned to them.
+#define DEPTH_TILE_SIZE 8
+
+// A full tile's ::DepthTile_t::farthest is recomputed once every this many
+// times it fails to hide something.
+#define DEPTH_TILE_REFRESH 4
+
+// The coarse depth of a square tile of a ::ZBuffer_t.
+typedef struct {
+	Point_t farthest; // Once ::empty is 0, no pixel in the tile is farther;
+		// ::ZBUFFER_EMPTY until it's first computed.
+	int empty; // The number of the tile's pixels that haven't been drawn.
+	int misses; // The times ::farthest hasn't hidden something since it was
+		// computed.
+	int pixels; // The number of pixels in the tile, on the screen.
+	unsigned generation; // The ::ZBuffer_t::generation the tile was last
+		// emptied in; its pixels, and the fields above, are stale if older.
+	int dirty; // Whether the tile's pixels have changed since
+		// ::takeDirtyRects() last returned it; set by whatever writes them.
+} DepthTile_t;
+
+// The byte alignment of the planes that a ::ZBuffer_t allocates itself.
+#define ZBUFFER_ALIGNMENT 32
+
+// The depth of a pixel that nothing has been drawn to, which anything drawn
+// is nearer than; its color is then black. ::writeZBufferToFile() writes such
+// a pixel with a depth of 0 and a color of -1. Finite, since the default build
+// assumes no infinities (-Ofast implies -ffinite-math-only).
+#define ZBUFFER_EMPTY (-FLT_MAX)
+
+/*
+ * @brief Return the offset of a pixel in the planes of a ::ZBuffer_t.
+ *
+ * @param zBuf (::ZBuffer_t *) The buffer.
+ * @param x (int) The column of the pixel.
+ * @param y (int) The row of the pixel.
+ */
+#define ZBUFFER_PIXEL(zBuf, x, y) ((y) * (zBuf)->width + (x))
+
+// The depth and color of every pixel of the screen, each in one contiguous
+// plane, row by row.
 typedef struct {
-	double ***buf; // 3D representation of each pixel's current height/color.
+	float *depth; // Each pixel's depth, or ::ZBUFFER_EMPTY; larger is nearer.
+	uint32_t *color; // Each pixel's color, as 0xRRGGBB.
+	int sharedColor; // Whether ::color belongs to someone else, like the SDL
+		// screen, and isn't freed with the buffer.
+	int width; // The number of pixels in a row of the planes; at least
+		// ::g_screenWidth.
+	DepthTile_t *tiles; // The coarse depth of ::depth, tile by tile, row by
+		// row.
+	int tileColumns; // The number of tiles across ::tiles.
+	unsigned generation; // The number of times the buffer has been cleared.
 } ZBuffer_t;
 
+// A rectangle of pixels, inclusive of its bounds.
+typedef struct {
+	int minX, minY, maxX, maxY;
+} PixelRect_t;
+
+//! Counts of the work saved by the coarse depth test.
+typedef struct {
+	long triangles; //! Triangles tested against the coarse depth.
+	long trianglesRejected; //! Tested triangles hidden wherever they'd draw.
+	long blocksRejected; //! Hidden blocks skipped by the edge rasterizer.
+	long pixelsRejected; //! Pixels in those triangles' and blocks' bounds.
+} DepthStats_t;
+
+//! Whether the rasterizers skip triangles and blocks that the coarse depth
+//! shows to be hidden; 1 by default.
+extern int g_depthCulling;
+
+//! The calling thread's ::DepthStats_t; tiles.h adds its threads' to the
+//! caller's.
+extern _Thread_local DepthStats_t g_depthStats;
+
+/*!
+ *  The pixels that the calling thread may plot: ::plotPixel() and
+ *  ::scanlineRender() leave everything outside it untouched. Covers the
+ *  whole screen unless a tile renderer narrows it; see tiles.h.
+ */
+extern _Thread_local PixelRect_t g_clipRect;
+
+/*!
+ *  @brief Empty a tile of a ::ZBuffer_t, and bring it up to the buffer's
+ *      generation.
+ *
+ *  Only the pixels of a tile that's been drawn to are written, so this costs
+ *  little for a tile that was already empty. Used by ::currentTile().
+ *
+ *  @param zBuf The buffer.
+ *  @param tile One of @p zBuf's tiles.
+ */
+void emptyTile(ZBuffer_t *zBuf, DepthTile_t *tile);
+
+/*!
+ *  @brief Return the tile of a ::ZBuffer_t that holds a pixel, emptying it
+ *      first if it's stale.
+ *
+ *  ::clearZBuffer() only starts a new generation, and leaves each tile to be
+ *  emptied when it's next used: this must be called before a tile's pixels or
+ *  coarse depth are read or written. Each tile lies within one of the tiles of
+ *  tiles.h, which only one thread renders at a time, so this needs no locking.
+ *
+ *  @param zBuf The buffer.
+ *  @param x The x-coordinate of a pixel in the tile.
+ *  @param y The y-coordinate of a pixel in the tile.
+ *
+ *  @return The tile.
+ */
+static inline DepthTile_t *currentTile(ZBuffer_t *zBuf, int x, int y){
+	DepthTile_t *tile = &zBuf->tiles[(unsigned)y / DEPTH_TILE_SIZE *
+		zBuf->tileColumns + (unsigned)x / DEPTH_TILE_SIZE];
+	if(tile->generation != zBuf->generation)
+		emptyTile(zBuf, tile);
+	return tile;
+}
+
+/*!
+ *  @brief Account for pixels drawn to a tile of a ::ZBuffer_t for the first
+ *      time in its coarse depth.
+ *
+ *  Must be called by everything that writes ::ZBuffer_t::depth, after
+ *  ::currentTile(). Drawing over a pixel needn't be accounted for, since it
+ *  only brings the pixel nearer.
+ *
+ *  @param zBuf The buffer.
+ *  @param x The x-coordinate of a pixel in the tile.
+ *  @param y The y-coordinate of a pixel in the tile.
+ *  @param filled The number of the tile's pixels drawn for the first time.
+ */
+static inline void markFilled(ZBuffer_t *zBuf, int x, int y, int filled){
+	zBuf->tiles[(unsigned)y / DEPTH_TILE_SIZE * zBuf->tileColumns +
+		(unsigned)x / DEPTH_TILE_SIZE].empty -= filled;
+}
+
+/*!
+ *  @brief Draw a pixel of a ::ZBuffer_t if it's nearer than what's there.
+ *
+ *  Unlike ::plotPixel(), takes the pixel's column and row, and doesn't check
+ *  them: they must lie on the screen and within ::g_clipRect.
+ *
+ *  @param zBuf The buffer.
+ *  @param x The column of the pixel.
+ *  @param y The row of the pixel.
+ *  @param depth The depth of the pixel.
+ *  @param color The color of the pixel.
+ */
+static inline void writePixel(ZBuffer_t *zBuf, int x, int y, Point_t depth,
+	int color){
+	// compared as stored, so that a tie is kept by the first pixel drawn
+	DepthTile_t *tile = currentTile(zBuf, x, y);
+	int pixel = ZBUFFER_PIXEL(zBuf, x, y);
+	float stored = depth;
+	if(zBuf->depth[pixel] < stored){
+		if(zBuf->depth[pixel] == ZBUFFER_EMPTY)
+			tile->empty--;
+		tile->dirty = 1;
+		zBuf->depth[pixel] = stored;
+		zBuf->color[pixel] = color;
+	}
+}
+
+/*!
+ *  @brief Clip a ::PixelRect_t to the screen and ::g_clipRect.
+ *
+ *  @param rect The rectangle to clip.
+ *
+ *  @return Whether any of @p rect is left.
+ */
+int clipRect(PixelRect_t *rect);
+
+/*!
+ *  @brief Return whether every pixel of a rectangle is nearer than a depth.
+ *
+ *  Tests the coarse depth of the tiles that @p rect overlaps: if they're
+ *  hidden, ::plotPixel() would draw nothing in @p rect at @p nearest or any
+ *  farther depth.
+ *
+ *  @param zBuf The buffer.
+ *  @param rect A rectangle clipped with ::clipRect().
+ *  @param nearest The nearest depth that might be drawn in @p rect.
+ */
+int hiddenRect(ZBuffer_t *zBuf, const PixelRect_t *rect, Point_t nearest);
+
 /*!
  *  @brief Initialize the SDL screen.
+ *
+ *  If the screen's pixels pass ::matchesColorPlane(), and it needn't be
+ *  locked, ::g_zbuffer's color plane is the screen's own memory; otherwise,
+ *  ::renderScreen() copies what changed into it.
  */
 void configureScreen(void);
 
+/*!
+ *  @brief Return whether a pixel format lays pixels out as a ::ZBuffer_t's
+ *      color plane does, as 0xRRGGBB in 32 bits.
+ *
+ *  @param bytesPerPixel The number of bytes per pixel.
+ *  @param redMask The bits of a pixel that hold its red channel.
+ *  @param greenMask The bits of a pixel that hold its green channel.
+ *  @param blueMask The bits of a pixel that hold its blue channel.
+ */
+int matchesColorPlane(int bytesPerPixel, uint32_t redMask, uint32_t greenMask,
+	uint32_t blueMask);
+
 /*!
  * @brief Draw a pixel to the SDL screen.
  *
@@ -74,7 +297,9 @@ void (plotPixel)(Point_t *pt, int color);
  *      ::plotPixel().
  *
  *  ::renderScreen() must be called for the SDL screen to display any newly
- *  rendered pixels.
+ *  rendered pixels. Only the rectangles of ::takeDirtyRects() are sent to
+ *  the display; nothing is copied, unless ::g_zbuffer's color plane isn't the
+ *  SDL screen's own memory (see ::configureScreen()).
  */
 void renderScreen(void);
 
@@ -94,7 +319,8 @@ void clearScreen(void);
 void quitScreen(void);
 
 /*!
- *  @brief Save the currently displayed SDL screen to a BMP file.
+ *  @brief Display the SDL screen, as drawn since the last ::clearScreen(),
+ *      with ::renderScreen(), and save it to a BMP file.
  *
  *  @param filename The path of the BMP file to save the screen to.
  */
@@ -107,6 +333,18 @@ int writeScreen(const char * const filename);
 */
 ZBuffer_t *createZBuffer(void);
 
+/*
+ * @brief Create a ::ZBuffer_t whose color plane is memory it doesn't own.
+ *
+ * @param color A plane of ::g_screenHeight rows of @p width pixels, which is
+ *      emptied, and outlives the buffer; NULL for the buffer to allocate its
+ *      own.
+ * @param width The number of pixels in a row of @p color.
+ *
+ * @return The new ::ZBuffer_t.
+*/
+ZBuffer_t *createZBufferOn(uint32_t *color, int width);
+
 /*
  * @brief Deallocate a ::ZBuffer_t.
  *
@@ -115,11 +353,40 @@ ZBuffer_t *createZBuffer(void);
 void freeZBuffer(ZBuffer_t *zBuf);
 
 /*
- * @brief Zero out a ::ZBuffer_t::buf.
+ * @brief Empty every pixel of a ::ZBuffer_t, and reset its coarse depth.
+ *
+ * Takes constant time: the buffer starts a new generation, and every tile
+ * still holding an older one counts as empty until ::currentTile() or
+ * ::flushZBuffer() empties it, so only the tiles drawn to are ever written.
  *
  * @param zBuf The ::ZBuffer_t to clear.
 */
 void clearZBuffer(ZBuffer_t *zBuf);
+
+/*
+ * @brief Collect the rectangles of a ::ZBuffer_t whose pixels have changed.
+ *
+ * The buffer is flushed, as by ::flushZBuffer(), so pixels emptied by the
+ * clears since the last call count as changed. Each rectangle is a run of whole
+ * tiles along a row of them.
+ *
+ * @param zBuf The buffer.
+ * @param rects Set to the rectangles; must have room for one per tile.
+ *
+ * @return The number of rectangles; the next call returns only those changed
+ *      after this one.
+*/
+int takeDirtyRects(ZBuffer_t *zBuf, PixelRect_t *rects);
+
+/*
+ * @brief Empty every stale tile of a ::ZBuffer_t.
+ *
+ * Must be called before a buffer's planes are read other than through
+ * ::currentTile(), as by ::takeDirtyRects() and the file I/O.
+ *
+ * @param zBuf The ::ZBuffer_t to bring up to date.
+*/
+void flushZBuffer(ZBuffer_t *zBuf);
 /*
  * @brief Recreate a ::ZBuffer_t from a file written with
  *      ::writeZBufferToFile().
@@ -133,14 +400,14 @@ ZBuffer_t *readZBufferFromFile(const char *filePath);
 /*
  * @brief Write a ::ZBuffer_t to a file.
  *
- * The ::ZBuffer_t::buf is written to a file named @p filePath in the following
- * format:
+ * The buffer's pixels are written to a file named @p filePath in the
+ * following format:
  *
- *      %(d1):%(f1),%(f2),...
+ *      %(d1), %(d2):%(f1),%(f2),...
  *
- *      %(d1) : The number of points in ::ZBuffer_t::buf.
- *      %(f1) : The z-coordinate of the first pixel.
- *      %(f2) : The color of the first pixel.
+ *      %(d1), %(d2) : The width and height of the buffer.
+ *      %(f1) : The z-coordinate of the first pixel, truncated; 0 if empty.
+ *      %(f2) : The color of the first pixel; -1 if empty.
  *      ... : The pattern "%(f1),%(f2)," for every other pixel.
  *
  * @param zBuf The ::ZBuffer_t to write.
@@ -151,13 +418,14 @@ void writeZBufferToFile(ZBuffer_t *zBuf, const char *filePath);
 /*
  * @brief Determine whether two ::ZBuffer_t are identical.
  *
- * The contents of ::ZBuffer_t::buf are inspected for equality. Note that both
- * ::ZBuffer_t::buf are expected to contain ::g_screenHeight * ::g_screenWidth
- * points; if one does not, undefined behavior ensues.
+ * The buffers' pixels are inspected for equality, within the
+ * ZBUFFER_*_TOLERANCE of single-precision builds. Note that both buffers
+ * are expected to hold ::g_screenHeight * ::g_screenWidth pixels; if one
+ * does not, undefined behavior ensues.
  *
  * @param zBuf1 The first ::ZBuffer_t.
  * @param zBuf2 The second ::ZBuffer_t.
  *
- * @return 1 if the ::ZBuffer_t::buf are equal; 0, otherwise.
+ * @return 1 if the buffers are equal; 0, otherwise.
 */
 int equalZBuffers(ZBuffer_t *zBuf1, ZBuffer_t *zBuf2);
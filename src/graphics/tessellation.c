@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "src/arena.h"
+#include "src/globals.h"
+#include "src/graphics/mesh.h"
+#include "src/graphics/tessellation.h"
+
+TessellationCache_t g_tessellationCache = {
+	.capacity = TESSELLATION_CACHE_CAPACITY
+};
+
+/*
+ * @brief Remove an entry from a ::TessellationCache_t's recency list.
+ *
+ * @param cache The cache that holds @p entry.
+ * @param entry The entry to unlink; it isn't freed.
+ */
+static void unlinkEntry(TessellationCache_t *cache,
+	TessellationEntry_t *entry);
+
+/*
+ * @brief Make an entry a ::TessellationCache_t's most recently used.
+ *
+ * @param cache The cache to add @p entry to.
+ * @param entry An entry that isn't in any recency list.
+ */
+static void pushEntry(TessellationCache_t *cache, TessellationEntry_t *entry);
+
+/*
+ * @brief Unlink and free an entry of a ::TessellationCache_t, and its mesh.
+ *
+ * @param cache The cache that holds @p entry.
+ * @param entry The entry to free.
+ */
+static void freeEntry(TessellationCache_t *cache, TessellationEntry_t *entry);
+
+Mesh_t *findTessellation(TessellationCache_t *cache,
+	const TessellationKey_t *key){
+	TessellationEntry_t *entry;
+	for(entry = cache->head; entry != NULL; entry = entry->next)
+		if(entry->key.shape == key->shape && entry->key.rad1 == key->rad1 &&
+			entry->key.rad2 == key->rad2 &&
+			entry->key.level.sides == key->level.sides &&
+			entry->key.level.theta == key->level.theta &&
+			entry->key.level.circles == key->level.circles)
+			break;
+
+	if(entry == NULL){
+		cache->misses++;
+		return NULL;
+	}
+
+	cache->hits++;
+	if(entry != cache->head){
+		unlinkEntry(cache, entry);
+		pushEntry(cache, entry);
+	}
+	return entry->mesh;
+}
+
+void cacheTessellation(TessellationCache_t *cache,
+	const TessellationKey_t *key, Mesh_t *mesh){
+	TessellationEntry_t *entry = malloc(sizeof(TessellationEntry_t));
+	if(entry == NULL)
+		FATAL("Failed to allocate a tessellation cache entry.");
+	g_allocationStats.systemAllocations++;
+
+	entry->key = *key;
+	entry->mesh = mesh;
+	entry->size = sizeof(Mesh_t) + mesh->capacity * sizeof(int) +
+		(mesh->vertices->capacity + mesh->normals->capacity) *
+		sizeof(*mesh->vertices->points);
+
+	while(cache->tail != NULL && cache->size + entry->size > cache->capacity){
+		freeEntry(cache, cache->tail);
+		cache->evictions++;
+	}
+
+	pushEntry(cache, entry);
+	cache->size += entry->size;
+}
+
+void clearTessellationCache(TessellationCache_t *cache){
+	while(cache->head != NULL)
+		freeEntry(cache, cache->head);
+}
+
+static void unlinkEntry(TessellationCache_t *cache,
+	TessellationEntry_t *entry){
+	if(entry->prev != NULL)
+		entry->prev->next = entry->next;
+	else
+		cache->head = entry->next;
+
+	if(entry->next != NULL)
+		entry->next->prev = entry->prev;
+	else
+		cache->tail = entry->prev;
+}
+
+static void pushEntry(TessellationCache_t *cache, TessellationEntry_t *entry){
+	entry->prev = NULL;
+	entry->next = cache->head;
+	if(cache->head != NULL)
+		cache->head->prev = entry;
+	else
+		cache->tail = entry;
+	cache->head = entry;
+}
+
+static void freeEntry(TessellationCache_t *cache, TessellationEntry_t *entry){
+	unlinkEntry(cache, entry);
+	cache->size -= entry->size;
+	freeMesh(entry->mesh);
+	free(entry);
+}
@@ -0,0 +1,99 @@
+/*!
+ *  @file
+ *  @brief A cache of tessellated primitives.
+ *
+ *  Spheres and tori are expensive to tessellate, but a script usually draws
+ *  the same few of them in every frame, at a different position or under a
+ *  different transformation. A ::TessellationCache_t keeps each primitive's
+ *  ::Mesh_t, built around the origin, keyed by its shape, radii and
+ *  tessellation level, so that drawing it again only costs a copy and a
+ *  translation. Once the cached meshes exceed the cache's memory cap, the
+ *  least recently used ones are evicted.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include "src/graphics/mesh.h"
+
+// The default memory cap of a ::TessellationCache_t, in bytes.
+#define TESSELLATION_CACHE_CAPACITY (32 << 20)
+
+//! The kinds of primitive that a ::TessellationCache_t holds.
+typedef enum {
+	SHAPE_SPHERE,
+	SHAPE_TORUS
+} Shape_t;
+
+//! How finely a primitive is tessellated.
+typedef struct {
+	int sides; //! The number of segments in each of the primitive's circles.
+	double theta; //! The angle, in radians, subtended by each segment.
+	int circles; //! The number of circles swept around the primitive's axis.
+} TessellationLevel_t;
+
+//! Identifies a tessellated primitive.
+typedef struct {
+	Shape_t shape; //! The kind of primitive.
+	double rad1; //! A sphere's radius, or a torus's minor radius.
+	double rad2; //! A torus's major radius; 0 for a sphere.
+	TessellationLevel_t level; //! The primitive's tessellation.
+} TessellationKey_t;
+
+//! A cached primitive, in a ::TessellationCache_t's recency list.
+typedef struct TessellationEntry_t {
+	struct TessellationEntry_t *prev; //! The next more recently used entry.
+	struct TessellationEntry_t *next; //! The next less recently used entry.
+	TessellationKey_t key; //! The primitive's key.
+	Mesh_t *mesh; //! The primitive, centered on the origin.
+	size_t size; //! The number of bytes ::mesh occupies.
+} TessellationEntry_t;
+
+//! A least-recently-used cache of tessellated primitives.
+typedef struct {
+	TessellationEntry_t *head; //! The most recently used entry.
+	TessellationEntry_t *tail; //! The least recently used entry.
+	size_t size; //! The number of bytes occupied by the cached meshes.
+	size_t capacity; //! The cap on ::size.
+	long hits; //! Lookups that found their primitive.
+	long misses; //! Lookups that didn't.
+	long evictions; //! Entries evicted to respect ::capacity.
+} TessellationCache_t;
+
+//! The cache used by ::addSphereMesh() and ::addTorusMesh().
+extern TessellationCache_t g_tessellationCache;
+
+/*!
+ *  @brief Find a primitive in a ::TessellationCache_t.
+ *
+ *  On success, the entry becomes the cache's most recently used.
+ *
+ *  @param cache The cache to search.
+ *  @param key The primitive to find.
+ *
+ *  @return The cached ::Mesh_t, which remains owned by @p cache and valid
+ *      until the next ::cacheTessellation(); NULL if it isn't cached.
+ */
+Mesh_t *findTessellation(TessellationCache_t *cache,
+	const TessellationKey_t *key);
+
+/*!
+ *  @brief Add a primitive to a ::TessellationCache_t.
+ *
+ *  Least recently used entries are evicted until the cache is within its
+ *  capacity; the new entry itself is never evicted by its own insertion.
+ *
+ *  @param cache The cache to add to.
+ *  @param key The primitive's key, which mustn't be cached already.
+ *  @param mesh The primitive; @p cache takes ownership of it.
+ */
+void cacheTessellation(TessellationCache_t *cache,
+	const TessellationKey_t *key, Mesh_t *mesh);
+
+/*!
+ *  @brief Free every primitive in a ::TessellationCache_t.
+ *
+ *  @param cache The cache to empty; its capacity and counters are kept.
+ */
+void clearTessellationCache(TessellationCache_t *cache);
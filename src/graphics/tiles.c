@@ -0,0 +1,315 @@
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tgmath.h>
+
+#include "src/arena.h"
+#include "src/globals.h"
+#include "src/graphics/screen.h"
+#include "src/graphics/tiles.h"
+
+// A lit triangle, copied when it's binned.
+typedef struct {
+	Point_t pos[3][4]; // The positions of the vertices.
+	RGB_t color[3][3]; // The colors of the vertices.
+} BinnedTriangle_t;
+
+// The triangles that overlap a tile.
+typedef struct {
+	int *triangles; // Indices into ::g_triangles, in order of submission.
+	int numTriangles; // The number of indices in ::triangles.
+	int capacity; // The number of indices ::triangles can hold.
+} TileBin_t;
+
+int g_renderThreads = 1;
+
+extern int g_screenWidth, g_screenHeight;
+
+static int g_binDepth; // The nesting depth of ::beginTiles() calls.
+static int g_binning; // Whether ::submitTriangle() bins triangles.
+
+static BinnedTriangle_t *g_triangles; // The triangles binned this frame.
+static int g_numTriangles, // The number of triangles in ::g_triangles.
+	g_triangleCapacity; // The number of triangles ::g_triangles can hold.
+
+static TileBin_t *g_bins; // The screen's tiles, row by row.
+static int g_tileColumns, // The number of tiles across the screen.
+	g_tileRows; // The number of tiles down the screen.
+
+static pthread_t g_workers[MAX_RENDER_THREADS]; // The pool's threads.
+static int g_numWorkers; // The number of threads in ::g_workers.
+static pthread_mutex_t g_poolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_frameStarted = PTHREAD_COND_INITIALIZER,
+	g_frameFinished = PTHREAD_COND_INITIALIZER;
+static long g_frame; // The number of frames handed to the pool.
+static int g_nextTile, // The index of the next tile to rasterize.
+	g_busyWorkers, // The number of workers still rasterizing this frame.
+	g_stopping; // Whether the workers should exit.
+static DepthStats_t g_workerStats; // The workers' ::g_depthStats this frame.
+
+/*
+ * @brief Fit ::g_bins to the screen, emptying every bin.
+ */
+static void resizeBins(void);
+
+/*
+ * @brief Add a triangle to a tile's bin.
+ *
+ * @param bin The tile's bin.
+ * @param triangle The triangle's index in ::g_triangles.
+ */
+static void addToBin(TileBin_t *bin, int triangle);
+
+/*
+ * @brief Rasterize tiles, taking the next one from ::g_nextTile until none
+ *      are left.
+ */
+static void rasterizeTiles(void);
+
+/*
+ * @brief Start or stop workers so that ::g_numWorkers is one less than
+ *      ::g_renderThreads.
+ */
+static void startRenderThreads(void);
+
+/*
+ * @brief Add one ::DepthStats_t to another.
+ *
+ * @param sum The stats to add to.
+ * @param stats The stats to add.
+ */
+static void addDepthStats(DepthStats_t *sum, const DepthStats_t *stats);
+
+/*
+ * @brief Stop every worker thread.
+ */
+static void joinRenderThreads(void);
+
+/*
+ * @brief The body of a worker thread: rasterize tiles every frame, until
+ *      ::g_stopping.
+ *
+ * @param arg The value of ::g_frame when the thread was started, cast to a
+ *      pointer.
+ */
+static void *renderWorker(void *arg);
+
+void beginTiles(void){
+	if(g_binDepth++ == 0 && 1 < g_renderThreads){
+		g_binning = 1;
+		resizeBins();
+	}
+}
+
+void submitTriangle(Light_t *l1, Light_t *l2, Light_t *l3){
+	if(!g_binning){
+		scanlineRender(l1, l2, l3);
+		return;
+	}
+
+	if(g_numTriangles == g_triangleCapacity){
+		g_triangleCapacity = (g_triangleCapacity == 0)?1024:
+			2 * g_triangleCapacity;
+		g_triangles = realloc(g_triangles,
+			g_triangleCapacity * sizeof(BinnedTriangle_t));
+		if(g_triangles == NULL)
+			FATAL("Failed to allocate %d binned triangles.",
+				g_triangleCapacity);
+		g_allocationStats.systemAllocations++;
+	}
+
+	BinnedTriangle_t *triangle = &g_triangles[g_numTriangles];
+	Light_t *lights[3] = {l1, l2, l3};
+	int vertex;
+	for(vertex = 0; vertex < 3; vertex++){
+		memcpy(triangle->pos[vertex], lights[vertex]->pos,
+			sizeof(triangle->pos[vertex]));
+		memcpy(triangle->color[vertex], lights[vertex]->color,
+			sizeof(triangle->color[vertex]));
+	}
+
+	PixelRect_t bounds = triangleBounds(triangle->pos[0], triangle->pos[1],
+		triangle->pos[2]);
+	if(!clipRect(&bounds))
+		return;
+
+	int column, row;
+	for(row = bounds.minY / TILE_SIZE; row <= bounds.maxY / TILE_SIZE; row++)
+		for(column = bounds.minX / TILE_SIZE;
+			column <= bounds.maxX / TILE_SIZE; column++)
+			addToBin(&g_bins[row * g_tileColumns + column], g_numTriangles);
+	g_numTriangles++;
+}
+
+void renderTiles(void){
+	if(--g_binDepth > 0 || !g_binning)
+		return;
+	g_binning = 0;
+
+	startRenderThreads();
+	pthread_mutex_lock(&g_poolLock);
+	g_nextTile = 0;
+	g_busyWorkers = g_numWorkers;
+	g_frame++;
+	pthread_cond_broadcast(&g_frameStarted);
+	pthread_mutex_unlock(&g_poolLock);
+
+	rasterizeTiles();
+
+	pthread_mutex_lock(&g_poolLock);
+	while(g_busyWorkers > 0)
+		pthread_cond_wait(&g_frameFinished, &g_poolLock);
+	addDepthStats(&g_depthStats, &g_workerStats);
+	g_workerStats = (DepthStats_t){0};
+	pthread_mutex_unlock(&g_poolLock);
+
+	g_numTriangles = 0;
+	int tile;
+	for(tile = 0; tile < g_tileColumns * g_tileRows; tile++)
+		g_bins[tile].numTriangles = 0;
+}
+
+void stopRenderThreads(void){
+	joinRenderThreads();
+
+	int tile;
+	for(tile = 0; tile < g_tileColumns * g_tileRows; tile++)
+		free(g_bins[tile].triangles);
+	free(g_bins);
+	free(g_triangles);
+	g_bins = NULL;
+	g_triangles = NULL;
+	g_tileColumns = g_tileRows = 0;
+	g_numTriangles = g_triangleCapacity = 0;
+}
+
+static void resizeBins(void){
+	int columns = (g_screenWidth + TILE_SIZE - 1) / TILE_SIZE,
+		rows = (g_screenHeight + TILE_SIZE - 1) / TILE_SIZE;
+	if(columns == g_tileColumns && rows == g_tileRows)
+		return;
+
+	int tile;
+	for(tile = 0; tile < g_tileColumns * g_tileRows; tile++)
+		free(g_bins[tile].triangles);
+	free(g_bins);
+
+	g_bins = calloc(columns * rows, sizeof(TileBin_t));
+	if(g_bins == NULL)
+		FATAL("Failed to allocate %d tiles.", columns * rows);
+	g_allocationStats.systemAllocations++;
+	g_tileColumns = columns;
+	g_tileRows = rows;
+}
+
+static void addToBin(TileBin_t *bin, int triangle){
+	if(bin->numTriangles == bin->capacity){
+		bin->capacity = (bin->capacity == 0)?64:2 * bin->capacity;
+		bin->triangles = realloc(bin->triangles,
+			bin->capacity * sizeof(int));
+		if(bin->triangles == NULL)
+			FATAL("Failed to allocate a bin of %d triangles.", bin->capacity);
+		g_allocationStats.systemAllocations++;
+	}
+	bin->triangles[bin->numTriangles++] = triangle;
+}
+
+static void rasterizeTiles(void){
+	while(1){
+		pthread_mutex_lock(&g_poolLock);
+		int tile = g_nextTile++;
+		pthread_mutex_unlock(&g_poolLock);
+		if(tile >= g_tileColumns * g_tileRows)
+			break;
+
+		TileBin_t *bin = &g_bins[tile];
+		if(bin->numTriangles == 0)
+			continue;
+
+		PixelRect_t screen = g_clipRect;
+		g_clipRect.minX = (tile % g_tileColumns) * TILE_SIZE;
+		g_clipRect.minY = (tile / g_tileColumns) * TILE_SIZE;
+		g_clipRect.maxX = g_clipRect.minX + TILE_SIZE - 1;
+		g_clipRect.maxY = g_clipRect.minY + TILE_SIZE - 1;
+
+		int index;
+		for(index = 0; index < bin->numTriangles; index++){
+			BinnedTriangle_t *triangle = &g_triangles[bin->triangles[index]];
+			scanlineRender(
+				&(Light_t){
+					.color = triangle->color[0],
+					.pos = triangle->pos[0]
+				},
+				&(Light_t){
+					.color = triangle->color[1],
+					.pos = triangle->pos[1]
+				},
+				&(Light_t){
+					.color = triangle->color[2],
+					.pos = triangle->pos[2]
+				}
+			);
+		}
+		g_clipRect = screen;
+	}
+}
+
+static void startRenderThreads(void){
+	int workers = (g_renderThreads < MAX_RENDER_THREADS)?
+		g_renderThreads - 1:MAX_RENDER_THREADS - 1;
+	if(workers == g_numWorkers)
+		return;
+
+	joinRenderThreads();
+	// a new worker waits for the frame after the current one
+	for(g_numWorkers = 0; g_numWorkers < workers; g_numWorkers++)
+		if(pthread_create(&g_workers[g_numWorkers], NULL, renderWorker,
+			(void *)(intptr_t)g_frame))
+			FATAL("Failed to start render thread %d.", g_numWorkers);
+}
+
+static void joinRenderThreads(void){
+	pthread_mutex_lock(&g_poolLock);
+	g_stopping = 1;
+	pthread_cond_broadcast(&g_frameStarted);
+	pthread_mutex_unlock(&g_poolLock);
+
+	int worker;
+	for(worker = 0; worker < g_numWorkers; worker++)
+		pthread_join(g_workers[worker], NULL);
+	g_numWorkers = 0;
+	g_stopping = 0;
+}
+
+static void *renderWorker(void *arg){
+	long frame = (intptr_t)arg;
+
+	pthread_mutex_lock(&g_poolLock);
+	while(1){
+		while(frame == g_frame && !g_stopping)
+			pthread_cond_wait(&g_frameStarted, &g_poolLock);
+		if(g_stopping)
+			break;
+		frame = g_frame;
+		pthread_mutex_unlock(&g_poolLock);
+
+		rasterizeTiles();
+
+		pthread_mutex_lock(&g_poolLock);
+		addDepthStats(&g_workerStats, &g_depthStats);
+		g_depthStats = (DepthStats_t){0};
+		if(--g_busyWorkers == 0)
+			pthread_cond_signal(&g_frameFinished);
+	}
+	pthread_mutex_unlock(&g_poolLock);
+	return NULL;
+}
+
+static void addDepthStats(DepthStats_t *sum, const DepthStats_t *stats){
+	sum->triangles += stats->triangles;
+	sum->trianglesRejected += stats->trianglesRejected;
+	sum->blocksRejected += stats->blocksRejected;
+	sum->pixelsRejected += stats->pixelsRejected;
+}
@@ -0,0 +1,67 @@
+/*!
+ *  @file
+ *  @brief Sort-middle rendering of triangles on a pool of threads.
+ *
+ *  Between ::beginTiles() and ::renderTiles(), ::submitTriangle() doesn't
+ *  rasterize a lit triangle, but bins it into every ::TILE_SIZE square tile
+ *  of the screen that its bounding box overlaps. ::renderTiles() then hands
+ *  the tiles out to ::g_renderThreads threads, each of which narrows its
+ *  ::g_clipRect to the tile at hand before rasterizing the tile's triangles,
+ *  so that threads write disjoint parts of ::g_zbuffer without any locking.
+ *  A tile's triangles are rasterized in the order they were submitted, and a
+ *  clipped triangle's pixels are computed as they would be without the clip,
+ *  so the output is bit-identical to rendering on a single thread.
+ */
+
+#pragma once
+
+#include "src/graphics/graphics.h"
+
+// The width and height of a tile, in pixels; a multiple of
+// ::RASTER_BLOCK_SIZE, so that no block of the edge rasterizer (or tile of the
+// coarse depth) is split between threads.
+#define TILE_SIZE 64
+
+// The greatest number of threads ::renderTiles() will use.
+#define MAX_RENDER_THREADS 256
+
+/*!
+ *  The number of threads that rasterize the screen's tiles, including the
+ *  one that calls ::renderTiles(). With 1, the default, ::submitTriangle()
+ *  rasterizes triangles immediately.
+ */
+extern int g_renderThreads;
+
+/*!
+ *  @brief Start binning submitted triangles, if ::g_renderThreads is greater
+ *      than 1.
+ *
+ *  Calls may nest; only the outermost ::renderTiles() rasterizes.
+ */
+void beginTiles(void);
+
+/*!
+ *  @brief Rasterize a lit triangle, as ::scanlineRender() does, or bin it
+ *      for ::renderTiles().
+ *
+ *  The vertices' positions and colors are copied.
+ *
+ *  @param l1 The position and color of the first vertex of the triangle.
+ *  @param l2 The position and color of the second vertex of the triangle.
+ *  @param l3 The position and color of the third vertex of the triangle.
+ */
+void submitTriangle(Light_t *l1, Light_t *l2, Light_t *l3);
+
+/*!
+ *  @brief Rasterize the triangles binned since the matching ::beginTiles().
+ *
+ *  Returns once every tile has been rasterized.
+ */
+void renderTiles(void);
+
+/*!
+ *  @brief Stop the render threads, and free the tiles' bins.
+ *
+ *  The threads are restarted by the next ::renderTiles() that needs them.
+ */
+void stopRenderThreads(void);
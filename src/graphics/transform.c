@@ -0,0 +1,427 @@
+#include <tgmath.h>
+#include <string.h>
+
+#include "src/graphics/matrix.h"
+#include "src/graphics/transform.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define X86_KERNELS
+#endif
+
+/*!
+ *  The ratio between degrees and radians -- faciliates conversion from the
+ *  former to the latter.
+ */
+#define RAD (M_PI / 180)
+
+// The number of points transformed per iteration of the vector kernels.
+#define KERNEL_BLOCK_SIZE 4
+
+// A vertex kernel: transforms @p numPoints points in place.
+typedef void (*VertexKernel_t)(const Mat4_t *transform, Point_t (*points)[4],
+	int numPoints);
+
+/*
+ * @brief Transform points one coordinate at a time.
+ *
+ * The reference implementation: every other kernel accumulates its products
+ * in the same order.
+ *
+ * @param transform The transformation to apply.
+ * @param points The points to transform in place.
+ * @param numPoints The number of points.
+ */
+static void scalarKernel(const Mat4_t *transform, Point_t (*points)[4],
+	int numPoints);
+
+#ifdef X86_KERNELS
+/*
+ * @brief Transform points with 128-bit SSE2 vectors: half a point per vector,
+ *      or a whole one in single precision.
+ *
+ * @params See ::scalarKernel().
+ */
+static void sse2Kernel(const Mat4_t *transform, Point_t (*points)[4],
+	int numPoints);
+
+/*
+ * @brief Transform points with 256-bit AVX vectors: a whole point per vector,
+ *      or two in single precision.
+ *
+ * @params See ::scalarKernel().
+ */
+__attribute__((target("avx")))
+static void avxKernel(const Mat4_t *transform, Point_t (*points)[4],
+	int numPoints);
+#endif
+
+/*
+ * @brief Return the kernel for a ::VERTEX_KERNEL_* identifier.
+ *
+ * @param kernel The identifier.
+ *
+ * @return A pointer to the kernel function, or NULL if the current CPU (or
+ *      build) doesn't support it.
+ */
+static VertexKernel_t findKernel(int kernel);
+
+// The kernel used by ::applyMat4(), or NULL before one has been selected.
+static VertexKernel_t g_vertexKernel = NULL;
+
+Mat4_t identityMat4(void){
+	return (Mat4_t){
+		.cols = {
+			{1, 0, 0, 0},
+			{0, 1, 0, 0},
+			{0, 0, 1, 0},
+			{0, 0, 0, 1}
+		}
+	};
+}
+
+Mat4_t translationMat4(Point_t *delta){
+	Mat4_t translation = identityMat4();
+	translation.cols[W][X] = delta[X];
+	translation.cols[W][Y] = delta[Y];
+	translation.cols[W][Z] = delta[Z];
+	return translation;
+}
+
+Mat4_t scaleMat4(Point_t *delta){
+	Mat4_t scale = identityMat4();
+	scale.cols[X][X] = delta[X];
+	scale.cols[Y][Y] = delta[Y];
+	scale.cols[Z][Z] = delta[Z];
+	return scale;
+}
+
+Mat4_t rotationMat4(int axis, double angle){
+	Mat4_t rotation = identityMat4();
+
+	double radAngle = angle * RAD;
+	double sinA = mathSin(radAngle), cosA = mathCos(radAngle);
+
+	// the two axes spanning the plane of rotation
+	int axis1, axis2;
+	if(axis == X_AXIS){
+		axis1 = Y;
+		axis2 = Z;
+	}
+
+	else if(axis == Y_AXIS){
+		axis1 = X;
+		axis2 = Z;
+	}
+
+	else {
+		axis1 = X;
+		axis2 = Y;
+	}
+
+	rotation.cols[axis1][axis1] = cosA;
+	rotation.cols[axis1][axis2] = sinA;
+	rotation.cols[axis2][axis1] = -sinA;
+	rotation.cols[axis2][axis2] = cosA;
+	return rotation;
+}
+
+Mat4_t composeMat4(const Mat4_t *m1, const Mat4_t *m2){
+	Mat4_t product;
+
+	int row, col;
+	for(col = 0; col < 4; col++)
+		for(row = 0; row < 4; row++)
+			product.cols[col][row] =
+				MAT4(m1, row, 0) * m2->cols[col][0] +
+				MAT4(m1, row, 1) * m2->cols[col][1] +
+				MAT4(m1, row, 2) * m2->cols[col][2] +
+				MAT4(m1, row, 3) * m2->cols[col][3];
+
+	return product;
+}
+
+Mat4_t composeMat4Chain(int numTransforms, const Mat4_t *chain){
+	Mat4_t product = chain[0];
+
+	int transform;
+	for(transform = 1; transform < numTransforms; transform++)
+		product = composeMat4(&chain[transform], &product);
+
+	return product;
+}
+
+int invertMat4(const Mat4_t *m, Mat4_t *inverse){
+	// 2x2 determinants of the top two and bottom two rows
+	Point_t s0 = MAT4(m, 0, 0) * MAT4(m, 1, 1) - MAT4(m, 1, 0) * MAT4(m, 0, 1),
+		s1 = MAT4(m, 0, 0) * MAT4(m, 1, 2) - MAT4(m, 1, 0) * MAT4(m, 0, 2),
+		s2 = MAT4(m, 0, 0) * MAT4(m, 1, 3) - MAT4(m, 1, 0) * MAT4(m, 0, 3),
+		s3 = MAT4(m, 0, 1) * MAT4(m, 1, 2) - MAT4(m, 1, 1) * MAT4(m, 0, 2),
+		s4 = MAT4(m, 0, 1) * MAT4(m, 1, 3) - MAT4(m, 1, 1) * MAT4(m, 0, 3),
+		s5 = MAT4(m, 0, 2) * MAT4(m, 1, 3) - MAT4(m, 1, 2) * MAT4(m, 0, 3);
+
+	Point_t c0 = MAT4(m, 2, 0) * MAT4(m, 3, 1) - MAT4(m, 3, 0) * MAT4(m, 2, 1),
+		c1 = MAT4(m, 2, 0) * MAT4(m, 3, 2) - MAT4(m, 3, 0) * MAT4(m, 2, 2),
+		c2 = MAT4(m, 2, 0) * MAT4(m, 3, 3) - MAT4(m, 3, 0) * MAT4(m, 2, 3),
+		c3 = MAT4(m, 2, 1) * MAT4(m, 3, 2) - MAT4(m, 3, 1) * MAT4(m, 2, 2),
+		c4 = MAT4(m, 2, 1) * MAT4(m, 3, 3) - MAT4(m, 3, 1) * MAT4(m, 2, 3),
+		c5 = MAT4(m, 2, 2) * MAT4(m, 3, 3) - MAT4(m, 3, 2) * MAT4(m, 2, 3);
+
+	Point_t det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	if(det == 0)
+		return 0;
+
+	Point_t invDet = 1 / det;
+	Mat4_t inv;
+
+	MAT4(&inv, 0, 0) = (MAT4(m, 1, 1) * c5 - MAT4(m, 1, 2) * c4 +
+		MAT4(m, 1, 3) * c3) * invDet;
+	MAT4(&inv, 0, 1) = (-MAT4(m, 0, 1) * c5 + MAT4(m, 0, 2) * c4 -
+		MAT4(m, 0, 3) * c3) * invDet;
+	MAT4(&inv, 0, 2) = (MAT4(m, 3, 1) * s5 - MAT4(m, 3, 2) * s4 +
+		MAT4(m, 3, 3) * s3) * invDet;
+	MAT4(&inv, 0, 3) = (-MAT4(m, 2, 1) * s5 + MAT4(m, 2, 2) * s4 -
+		MAT4(m, 2, 3) * s3) * invDet;
+
+	MAT4(&inv, 1, 0) = (-MAT4(m, 1, 0) * c5 + MAT4(m, 1, 2) * c2 -
+		MAT4(m, 1, 3) * c1) * invDet;
+	MAT4(&inv, 1, 1) = (MAT4(m, 0, 0) * c5 - MAT4(m, 0, 2) * c2 +
+		MAT4(m, 0, 3) * c1) * invDet;
+	MAT4(&inv, 1, 2) = (-MAT4(m, 3, 0) * s5 + MAT4(m, 3, 2) * s2 -
+		MAT4(m, 3, 3) * s1) * invDet;
+	MAT4(&inv, 1, 3) = (MAT4(m, 2, 0) * s5 - MAT4(m, 2, 2) * s2 +
+		MAT4(m, 2, 3) * s1) * invDet;
+
+	MAT4(&inv, 2, 0) = (MAT4(m, 1, 0) * c4 - MAT4(m, 1, 1) * c2 +
+		MAT4(m, 1, 3) * c0) * invDet;
+	MAT4(&inv, 2, 1) = (-MAT4(m, 0, 0) * c4 + MAT4(m, 0, 1) * c2 -
+		MAT4(m, 0, 3) * c0) * invDet;
+	MAT4(&inv, 2, 2) = (MAT4(m, 3, 0) * s4 - MAT4(m, 3, 1) * s2 +
+		MAT4(m, 3, 3) * s0) * invDet;
+	MAT4(&inv, 2, 3) = (-MAT4(m, 2, 0) * s4 + MAT4(m, 2, 1) * s2 -
+		MAT4(m, 2, 3) * s0) * invDet;
+
+	MAT4(&inv, 3, 0) = (-MAT4(m, 1, 0) * c3 + MAT4(m, 1, 1) * c1 -
+		MAT4(m, 1, 2) * c0) * invDet;
+	MAT4(&inv, 3, 1) = (MAT4(m, 0, 0) * c3 - MAT4(m, 0, 1) * c1 +
+		MAT4(m, 0, 2) * c0) * invDet;
+	MAT4(&inv, 3, 2) = (-MAT4(m, 3, 0) * s3 + MAT4(m, 3, 1) * s1 -
+		MAT4(m, 3, 2) * s0) * invDet;
+	MAT4(&inv, 3, 3) = (MAT4(m, 2, 0) * s3 - MAT4(m, 2, 1) * s1 +
+		MAT4(m, 2, 2) * s0) * invDet;
+
+	*inverse = inv;
+	return 1;
+}
+
+int normalMat4(const Mat4_t *transform, Mat4_t *normal){
+	Mat4_t inverse;
+	if(!invertMat4(transform, &inverse))
+		return 0;
+
+	*normal = identityMat4();
+	int row, col;
+	for(row = 0; row < 3; row++)
+		for(col = 0; col < 3; col++)
+			MAT4(normal, row, col) = MAT4(&inverse, col, row);
+	return 1;
+}
+
+void applyMat4(const Mat4_t *transform, Matrix_t * const points){
+	if(g_vertexKernel == NULL)
+		setVertexKernel(VERTEX_KERNEL_AUTO);
+	g_vertexKernel(transform, points->points, points->numPoints);
+}
+
+void applyMat4Chain(int numTransforms, const Mat4_t *chain,
+	Matrix_t * const points){
+	if(numTransforms < 1)
+		return;
+
+	Mat4_t product = composeMat4Chain(numTransforms, chain);
+	applyMat4(&product, points);
+}
+
+int setVertexKernel(int kernel){
+	if(kernel == VERTEX_KERNEL_AUTO){
+		int fastest;
+		for(fastest = VERTEX_KERNEL_AVX; fastest > VERTEX_KERNEL_SCALAR;
+			fastest--)
+			if(findKernel(fastest) != NULL)
+				break;
+		kernel = fastest;
+	}
+
+	VertexKernel_t found = findKernel(kernel);
+	if(found == NULL)
+		return 0;
+
+	g_vertexKernel = found;
+	return 1;
+}
+
+Mat4_t mat4FromMatrix(const Matrix_t *matrix){
+	Mat4_t mat4;
+	memcpy(mat4.cols, matrix->points, sizeof(mat4.cols));
+	return mat4;
+}
+
+Matrix_t *matrixFromMat4(const Mat4_t *matrix){
+	Matrix_t *copy = createMatrix();
+	reserveMatrix(copy, 4);
+	memcpy(copy->points, matrix->cols, sizeof(matrix->cols));
+	copy->numPoints = 4;
+	return copy;
+}
+
+static void scalarKernel(const Mat4_t *transform, Point_t (*points)[4],
+	int numPoints){
+	const Point_t *c0 = transform->cols[0], *c1 = transform->cols[1],
+		*c2 = transform->cols[2], *c3 = transform->cols[3];
+
+	int point;
+	for(point = 0; point < numPoints; point++){
+		Point_t *pt = points[point];
+		Point_t x = pt[X], y = pt[Y], z = pt[Z], w = pt[W];
+
+		pt[X] = c0[X] * x + c1[X] * y + c2[X] * z + c3[X] * w;
+		pt[Y] = c0[Y] * x + c1[Y] * y + c2[Y] * z + c3[Y] * w;
+		pt[Z] = c0[Z] * x + c1[Z] * y + c2[Z] * z + c3[Z] * w;
+		pt[W] = c0[W] * x + c1[W] * y + c2[W] * z + c3[W] * w;
+	}
+}
+
+#ifdef X86_KERNELS
+#ifdef SINGLE_PRECISION
+static void sse2Kernel(const Mat4_t *transform, Point_t (*points)[4],
+	int numPoints){
+	__m128 c0 = _mm_load_ps(transform->cols[0]),
+		c1 = _mm_load_ps(transform->cols[1]),
+		c2 = _mm_load_ps(transform->cols[2]),
+		c3 = _mm_load_ps(transform->cols[3]);
+
+	int point;
+	for(point = 0; point < numPoints; point++){
+		Point_t *pt = points[point];
+		__m128 xy = _mm_add_ps(_mm_mul_ps(c0, _mm_load1_ps(&pt[X])),
+			_mm_mul_ps(c1, _mm_load1_ps(&pt[Y])));
+		_mm_store_ps(pt, _mm_add_ps(
+			_mm_add_ps(xy, _mm_mul_ps(c2, _mm_load1_ps(&pt[Z]))),
+			_mm_mul_ps(c3, _mm_load1_ps(&pt[W]))));
+	}
+}
+
+__attribute__((target("avx")))
+static void avxKernel(const Mat4_t *transform, Point_t (*points)[4],
+	int numPoints){
+	// each column, repeated in both 128-bit lanes
+	__m256 c0 = _mm256_broadcast_ps((const __m128 *)transform->cols[0]),
+		c1 = _mm256_broadcast_ps((const __m128 *)transform->cols[1]),
+		c2 = _mm256_broadcast_ps((const __m128 *)transform->cols[2]),
+		c3 = _mm256_broadcast_ps((const __m128 *)transform->cols[3]);
+
+	// two points per vector, one per lane
+	int point = 0;
+	for(; point + 2 <= numPoints; point += 2){
+		__m256 pts = _mm256_load_ps(points[point]);
+		__m256 xy = _mm256_add_ps(
+			_mm256_mul_ps(c0, _mm256_permute_ps(pts, 0x00)),
+			_mm256_mul_ps(c1, _mm256_permute_ps(pts, 0x55)));
+		_mm256_store_ps(points[point], _mm256_add_ps(
+			_mm256_add_ps(xy, _mm256_mul_ps(c2, _mm256_permute_ps(pts, 0xAA))),
+			_mm256_mul_ps(c3, _mm256_permute_ps(pts, 0xFF))));
+	}
+
+	if(point < numPoints)
+		sse2Kernel(transform, points + point, numPoints - point);
+}
+
+#else
+static void sse2Kernel(const Mat4_t *transform, Point_t (*points)[4],
+	int numPoints){
+	// the (x, y) and (z, w) halves of each column
+	__m128d c0xy = _mm_load_pd(&transform->cols[0][X]),
+		c0zw = _mm_load_pd(&transform->cols[0][Z]),
+		c1xy = _mm_load_pd(&transform->cols[1][X]),
+		c1zw = _mm_load_pd(&transform->cols[1][Z]),
+		c2xy = _mm_load_pd(&transform->cols[2][X]),
+		c2zw = _mm_load_pd(&transform->cols[2][Z]),
+		c3xy = _mm_load_pd(&transform->cols[3][X]),
+		c3zw = _mm_load_pd(&transform->cols[3][Z]);
+
+	int point;
+	for(point = 0; point < numPoints; point++){
+		Point_t *pt = points[point];
+		__m128d x = _mm_load1_pd(&pt[X]), y = _mm_load1_pd(&pt[Y]),
+			z = _mm_load1_pd(&pt[Z]), w = _mm_load1_pd(&pt[W]);
+
+		__m128d xy = _mm_add_pd(_mm_mul_pd(c0xy, x), _mm_mul_pd(c1xy, y));
+		__m128d zw = _mm_add_pd(_mm_mul_pd(c0zw, x), _mm_mul_pd(c1zw, y));
+		xy = _mm_add_pd(_mm_add_pd(xy, _mm_mul_pd(c2xy, z)),
+			_mm_mul_pd(c3xy, w));
+		zw = _mm_add_pd(_mm_add_pd(zw, _mm_mul_pd(c2zw, z)),
+			_mm_mul_pd(c3zw, w));
+
+		_mm_store_pd(&pt[X], xy);
+		_mm_store_pd(&pt[Z], zw);
+	}
+}
+
+__attribute__((target("avx")))
+static void avxKernel(const Mat4_t *transform, Point_t (*points)[4],
+	int numPoints){
+	__m256d c0 = _mm256_load_pd(transform->cols[0]),
+		c1 = _mm256_load_pd(transform->cols[1]),
+		c2 = _mm256_load_pd(transform->cols[2]),
+		c3 = _mm256_load_pd(transform->cols[3]);
+
+	int point = 0;
+	for(; point + KERNEL_BLOCK_SIZE <= numPoints; point += KERNEL_BLOCK_SIZE){
+		__m256d result[KERNEL_BLOCK_SIZE];
+
+		int block;
+		for(block = 0; block < KERNEL_BLOCK_SIZE; block++){
+			Point_t *pt = points[point + block];
+			__m256d xy = _mm256_add_pd(
+				_mm256_mul_pd(c0, _mm256_broadcast_sd(&pt[X])),
+				_mm256_mul_pd(c1, _mm256_broadcast_sd(&pt[Y])));
+			result[block] = _mm256_add_pd(
+				_mm256_add_pd(xy,
+					_mm256_mul_pd(c2, _mm256_broadcast_sd(&pt[Z]))),
+				_mm256_mul_pd(c3, _mm256_broadcast_sd(&pt[W])));
+		}
+
+		for(block = 0; block < KERNEL_BLOCK_SIZE; block++)
+			_mm256_store_pd(points[point + block], result[block]);
+	}
+
+	for(; point < numPoints; point++){
+		Point_t *pt = points[point];
+		__m256d xy = _mm256_add_pd(
+			_mm256_mul_pd(c0, _mm256_broadcast_sd(&pt[X])),
+			_mm256_mul_pd(c1, _mm256_broadcast_sd(&pt[Y])));
+		_mm256_store_pd(pt, _mm256_add_pd(
+			_mm256_add_pd(xy, _mm256_mul_pd(c2, _mm256_broadcast_sd(&pt[Z]))),
+			_mm256_mul_pd(c3, _mm256_broadcast_sd(&pt[W]))));
+	}
+}
+#endif
+#endif
+
+static VertexKernel_t findKernel(int kernel){
+	switch(kernel){
+		case VERTEX_KERNEL_SCALAR:
+			return &scalarKernel;
+
+#ifdef X86_KERNELS
+		case VERTEX_KERNEL_SSE2:
+			return __builtin_cpu_supports("sse2")?&sse2Kernel:NULL;
+
+		case VERTEX_KERNEL_AVX:
+			return __builtin_cpu_supports("avx")?&avxKernel:NULL;
+#endif
+
+		default:
+			return NULL;
+	}
+}
@@ -0,0 +1,163 @@
+/*!
+ * @file
+ * @brief Fixed-size 4x4 transformation matrices.
+ *
+ * ::Mat4_t is a value type: transformations are built, composed and inverted
+ * on the stack, without the heap allocations that a 4-point ::Matrix_t
+ * requires.
+ */
+
+#pragma once
+
+#include "src/graphics/matrix.h"
+
+/*
+ * @brief Access an element of a ::Mat4_t by row and column.
+ *
+ * @param matrix (::Mat4_t *) A matrix.
+ * @param row (int) The row of the element.
+ * @param col (int) The column of the element.
+ */
+#define MAT4(matrix, row, col) ((matrix)->cols[col][row])
+
+// Identifiers for the kernels ::applyMat4() can use; see ::setVertexKernel().
+#define VERTEX_KERNEL_AUTO -1 // The fastest kernel the CPU supports.
+#define VERTEX_KERNEL_SCALAR 0 // Plain C; always available.
+#define VERTEX_KERNEL_SSE2 1 // x86 SSE2.
+#define VERTEX_KERNEL_AVX 2 // x86 AVX.
+
+/*
+ * A 4x4 transformation matrix.
+ *
+ * The matrix is stored column by column, like the points of a ::Matrix_t: the
+ * fourth column of a translation holds its displacement.
+ */
+typedef struct {
+	_Alignas(MATRIX_ALIGNMENT) Point_t cols[4][4]; // The matrix's columns.
+} Mat4_t;
+
+/*!
+ *  @brief Return a @a 4x4 identity matrix.
+ */
+Mat4_t identityMat4(void);
+
+/*!
+ *  @brief Return a matrix used for translations.
+ *
+ *  @param delta A point representation of the translation displacements.
+ */
+Mat4_t translationMat4(Point_t *delta);
+
+/*!
+ *  @brief Return a matrix used for scaling.
+ *
+ *  @param delta A point representation of the scale factors.
+ */
+Mat4_t scaleMat4(Point_t *delta);
+
+/*!
+ *  @brief Return a matrix that rotates @p angle degrees through the @p axis.
+ *
+ *  @param axis The axis to rotate through.
+ *  @param angle The number of degrees to rotate by.
+ */
+Mat4_t rotationMat4(int axis, double angle);
+
+/*!
+ *  @brief Compose two transformations.
+ *
+ *  @param m1 The transformation to apply second.
+ *  @param m2 The transformation to apply first.
+ *
+ *  @return The product @f$m1 \cdot m2@f$.
+ */
+Mat4_t composeMat4(const Mat4_t *m1, const Mat4_t *m2);
+
+/*!
+ *  @brief Compose a chain of transformations into one.
+ *
+ *  @param numTransforms The number of transformations in @p chain; at least 1.
+ *  @param chain The transformations, in the order they're to be applied.
+ *
+ *  @return The product @f$chain_{n-1} \cdot \ldots \cdot chain_0@f$.
+ */
+Mat4_t composeMat4Chain(int numTransforms, const Mat4_t *chain);
+
+/*!
+ *  @brief Invert a transformation.
+ *
+ *  @param matrix The matrix to invert.
+ *  @param inverse Set to the inverse of @p matrix, if it exists.
+ *
+ *  @return 1 if @p matrix is invertible; 0 otherwise, in which case
+ *      @p inverse is left untouched.
+ */
+int invertMat4(const Mat4_t *matrix, Mat4_t *inverse);
+
+/*!
+ *  @brief Return the transformation that carries surface normals along with
+ *      a transformation of points.
+ *
+ *  That's the inverse-transpose of the upper-left 3x3 of @p transform, which
+ *  keeps normals perpendicular to their surfaces under non-uniform scaling.
+ *  Transformed normals aren't unit length in general.
+ *
+ *  @param transform The transformation applied to the points.
+ *  @param normal Set to the normal transformation, if it exists.
+ *
+ *  @return 1 if @p transform is invertible; 0 otherwise, in which case
+ *      @p normal is left untouched.
+ */
+int normalMat4(const Mat4_t *transform, Mat4_t *normal);
+
+/*!
+ *  @brief Multiply every point of a ::Matrix_t by a ::Mat4_t (in place).
+ *
+ *  Points are transformed by the kernel chosen with ::setVertexKernel(), or
+ *  by the fastest one available if none was.
+ *
+ *  @param transform The transformation to apply.
+ *  @param points The ::Matrix_t whose points will be transformed.
+ */
+void applyMat4(const Mat4_t *transform, Matrix_t *const points);
+
+/*!
+ *  @brief Apply a chain of transformations to every point of a ::Matrix_t.
+ *
+ *  The chain is composed with ::composeMat4Chain() first, so the points are
+ *  traversed once however long the chain is.
+ *
+ *  @param numTransforms The number of transformations in @p chain.
+ *  @param chain The transformations, in the order they're to be applied.
+ *  @param points The ::Matrix_t whose points will be transformed.
+ */
+void applyMat4Chain(int numTransforms, const Mat4_t *chain,
+	Matrix_t *const points);
+
+/*!
+ *  @brief Select the kernel used by ::applyMat4().
+ *
+ *  All kernels accumulate their products in the same order, so they give
+ *  identical results (barring compiler reassociation, as under -Ofast); they
+ *  differ only in speed.
+ *
+ *  @param kernel One of the VERTEX_KERNEL_* identifiers.
+ *
+ *  @return 1 if the kernel was selected; 0 if the CPU or build doesn't
+ *      support it, in which case the current kernel is kept.
+ */
+int setVertexKernel(int kernel);
+
+/*!
+ *  @brief Convert the first four points of a ::Matrix_t to a ::Mat4_t.
+ *
+ *  @param matrix A ::Matrix_t with at least four points.
+ */
+Mat4_t mat4FromMatrix(const Matrix_t *matrix);
+
+/*!
+ *  @brief Return a newly allocated, four-point ::Matrix_t copy of a ::Mat4_t.
+ *
+ *  @param matrix The ::Mat4_t to copy.
+ */
+Matrix_t *matrixFromMat4(const Mat4_t *matrix);
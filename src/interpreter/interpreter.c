@@ -1,15 +1,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <tgmath.h>
 #include <unistd.h>
 
+#include "src/arena.h"
 #include "src/globals.h"
+#include "src/graphics/camera.h"
 #include "src/graphics/screen.h"
 #include "src/graphics/geometry.h"
+#include "src/graphics/graphics.h"
 #include "src/graphics/matrix.h"
+#include "src/graphics/mesh.h"
+#include "src/graphics/tessellation.h"
+#include "src/graphics/tiles.h"
+#include "src/graphics/transform.h"
 #include "src/interpreter/interpreter.h"
 #include "src/interpreter/stack/point.h"
-#include "src/interpreter/stack/stack.h"
+#include "src/interpreter/stack/transform_stack.h"
 
 #include "lib/parser.h"
 #include "bin/y.tab.h"
@@ -97,10 +105,18 @@ int initializeVariables(){
 }
 
 void evaluateMDLScript(){
+	TransformStack_t * coordStack = createTransformStack();
+	Matrix_t * points = createMatrix();
+	Mesh_t * mesh = createMesh();
+
 	int frame;
 	for(frame = 0; frame < g_numFrames; frame++){
-		Matrix_t * points = createMatrix();
-		Stack_t * coordStack = createStack();
+		resetTransformStack(coordStack);
+		g_camera = orthographicCamera();
+
+		// the latest `camera` command, and `focal` length (0 for none)
+		struct symCamera * camera = NULL;
+		double focal = 0;
 
 		int cmdNum;
 		for(cmdNum = 0; cmdNum < lastop; cmdNum++){
@@ -109,12 +125,40 @@ void evaluateMDLScript(){
 
 			if(opCode == BOX){
 				struct symBox * box = &(cmd->op.box);
-				addRectangularPrism(points,
-					POINT(box->d0[0], box->d0[1], box->d0[2]),
-					POINT(box->d1[0], box->d1[1], box->d1[2]));
-				multiplyMatrix(peek(coordStack), points);
-				drawMatrix(points);
-				CLEAR(points);
+				double * corner = box->d0, * size = box->d1;
+				Mat4_t lod;
+				if(!sphereInView(&g_camera,
+						POINT(corner[0] + size[0] / 2, corner[1] - size[1] / 2,
+							corner[2] - size[2] / 2),
+						sqrt(size[0] * size[0] + size[1] * size[1] +
+							size[2] * size[2]) / 2,
+						peekTransform(coordStack), &lod))
+					continue;
+
+				addRectangularPrismMesh(mesh,
+					POINT(corner[0], corner[1], corner[2]),
+					POINT(size[0], size[1], size[2]));
+				transformMesh(peekTransform(coordStack), mesh);
+				drawMesh(mesh);
+				clearMesh(mesh);
+			}
+
+			else if(opCode == CAMERA || opCode == FOCAL){
+				if(opCode == CAMERA)
+					camera = &(cmd->op.camera);
+				else
+					focal = cmd->op.focal.value;
+
+				// without a `camera`, the eye looks at the origin from the
+				// focal length, so the z = 0 plane keeps its orthographic size
+				if(camera)
+					g_camera = perspectiveCamera(
+						POINT(camera->eye[0], camera->eye[1], camera->eye[2]),
+						POINT(camera->aim[0], camera->aim[1], camera->aim[2]),
+						focal);
+				else
+					g_camera = perspectiveCamera(POINT(0, 0, focal),
+						POINT(0, 0, 0), focal);
 			}
 
 			else if(opCode == DISPLAY)
@@ -125,8 +169,10 @@ void evaluateMDLScript(){
 				addEdge(points,
 					POINT(line->p0[0], line->p0[1], line->p0[2]),
 					POINT(line->p1[0], line->p1[1], line->p1[2]));
-				multiplyMatrix(peek(coordStack), points);
-				drawMatrix(points);
+				applyMat4(peekTransform(coordStack), points);
+				projectEdges(&g_camera, points);
+				if(points->numPoints == 2)
+					drawLine(points->points[0], points->points[1]);
 				CLEAR(points);
 			}
 
@@ -141,17 +187,15 @@ void evaluateMDLScript(){
 					dz *= scale;
 				}
 
-				Matrix_t * translation = createTranslation(POINT(dx, dy, dz));
-				multiplyMatrix(peek(coordStack), translation);
-				freeMatrix(pop(coordStack));
-				push(coordStack, translation);
+				Mat4_t translation = translationMat4(POINT(dx, dy, dz));
+				multiplyTransform(coordStack, &translation);
 			}
 
 			else if(opCode == POP)
-				freeMatrix(pop(coordStack));
+				popTransform(coordStack);
 
 			else if(opCode == PUSH)
-				push(coordStack, copyMatrix(peek(coordStack)));
+				pushTransform(coordStack);
 
 			else if(opCode == ROTATE){
 				struct symRotate * symRot = &(cmd->op.rotate);
@@ -161,10 +205,8 @@ void evaluateMDLScript(){
 					angle *= findVariable(symRot->p->name)->
 							gradient[frame];
 
-				Matrix_t * rotation = createRotation((int)symRot->axis, angle);
-				multiplyMatrix(peek(coordStack), rotation);
-				freeMatrix(pop(coordStack));
-				push(coordStack, rotation);
+				Mat4_t rotation = rotationMat4((int)symRot->axis, angle);
+				multiplyTransform(coordStack, &rotation);
 			}
 
 			else if(opCode == SAVE)
@@ -183,34 +225,49 @@ void evaluateMDLScript(){
 					dz *= scale;
 				}
 
-				Matrix_t * scale = createScale(POINT(dx, dy, dz));
-				multiplyMatrix(peek(coordStack), scale);
-				freeMatrix(pop(coordStack));
-				push(coordStack, scale);
+				Mat4_t scale = scaleMat4(POINT(dx, dy, dz));
+				multiplyTransform(coordStack, &scale);
 			}
 
 			else if(opCode == SPHERE){
 				struct symSphere * sphere = &(cmd->op.sphere);
-				addSphere(points, POINT(sphere->d[0], sphere->d[1]), sphere->r);
-				multiplyMatrix(peek(coordStack), points);
-				drawMatrix(points);
-				CLEAR(points);
+				Point_t * center = POINT(sphere->d[0], sphere->d[1]);
+				Mat4_t lod;
+				if(!sphereInView(&g_camera, center, sphere->r,
+						peekTransform(coordStack), &lod))
+					continue;
+
+				addSphereMeshLOD(mesh, center, sphere->r, &lod);
+				transformMesh(peekTransform(coordStack), mesh);
+				drawMesh(mesh);
+				clearMesh(mesh);
 			}
 
 			else if(opCode == TORUS){
 				struct symTorus * torus = &(cmd->op.torus);
-				addTorus(points, POINT(torus->d[0], torus->d[1]), torus->r0,
-						torus->r1);
-				multiplyMatrix(peek(coordStack), points);
-				drawMatrix(points);
-				CLEAR(points);
+				Point_t * center = POINT(torus->d[0], torus->d[1]);
+				Mat4_t lod;
+				if(!sphereInView(&g_camera, center, torus->r0 + torus->r1,
+						peekTransform(coordStack), &lod))
+					continue;
+
+				addTorusMeshLOD(mesh, center, torus->r0, torus->r1, &lod);
+				transformMesh(peekTransform(coordStack), mesh);
+				drawMesh(mesh);
+				clearMesh(mesh);
 			}
 		}
 
 		clearScreen();
-		freeMatrix(points);
-		freeStack(coordStack, &freeMatrixFromVoid);
+		resetArena(&g_frameArena);
 	}
+	g_camera = orthographicCamera();
+	freeTransformStack(coordStack);
+	freeMatrix(points);
+	freeMesh(mesh);
+	freeArena(&g_frameArena);
+	clearTessellationCache(&g_tessellationCache);
+	stopRenderThreads();
 
 	int gradient;
 	for(gradient = 0; gradient < g_numVariables; gradient++)
@@ -6,7 +6,6 @@
 #pragma once
 
 #include "src/graphics/matrix.h"
-#include "src/interpreter/stack/stack.h"
 
 /*
  * @brief Initialize an MDL script's constants and variables.
@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/arena.h"
+#include "src/globals.h"
+#include "src/interpreter/stack/transform_stack.h"
+
+// The number of matrices a ::TransformStack_t first has room for.
+#define TRANSFORM_STACK_MIN_CAPACITY 8
+
+TransformStack_t *createTransformStack(void){
+	TransformStack_t *stack = malloc(sizeof(TransformStack_t));
+	stack->capacity = TRANSFORM_STACK_MIN_CAPACITY;
+	if(posix_memalign((void **)&stack->transforms, MATRIX_ALIGNMENT,
+		stack->capacity * sizeof(Mat4_t)))
+		FATAL("Failed to allocate the transformation stack.");
+	g_allocationStats.systemAllocations += 2;
+
+	resetTransformStack(stack);
+	return stack;
+}
+
+void resetTransformStack(TransformStack_t *stack){
+	stack->depth = 1;
+	stack->transforms[0] = identityMat4();
+}
+
+void pushTransform(TransformStack_t *stack){
+	if(stack->depth == stack->capacity){
+		Mat4_t *transforms;
+		if(posix_memalign((void **)&transforms, MATRIX_ALIGNMENT,
+			2 * stack->capacity * sizeof(Mat4_t)))
+			FATAL("Failed to grow the transformation stack.");
+		g_allocationStats.systemAllocations++;
+
+		memcpy(transforms, stack->transforms, stack->depth * sizeof(Mat4_t));
+		free(stack->transforms);
+		stack->transforms = transforms;
+		stack->capacity *= 2;
+	}
+
+	stack->transforms[stack->depth] = stack->transforms[stack->depth - 1];
+	stack->depth++;
+}
+
+void popTransform(TransformStack_t *stack){
+	if(stack->depth == 1)
+		ERROR("Cannot pop the bottom of the transformation stack.");
+	else
+		stack->depth--;
+}
+
+void multiplyTransform(TransformStack_t *stack, const Mat4_t *transform){
+	Mat4_t *top = peekTransform(stack);
+	*top = composeMat4(top, transform);
+}
+
+void freeTransformStack(TransformStack_t *stack){
+	free(stack->transforms);
+	free(stack);
+}
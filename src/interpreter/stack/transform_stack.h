@@ -0,0 +1,77 @@
+/*!
+ *  @file
+ *  @brief A LIFO stack of ::Mat4_t, used by the interpreter's coordinate
+ *      system.
+ *
+ *  Matrices are stored by value in a single growable array, so pushing,
+ *  popping and transforming the top of the stack don't touch the heap once
+ *  the stack is deep enough.
+ */
+
+#pragma once
+
+#include "src/graphics/transform.h"
+
+/*
+ * @brief Return a pointer to the top ::Mat4_t of a ::TransformStack_t.
+ *
+ * @param stack (::TransformStack_t *)
+ *
+ * @return (::Mat4_t *)
+ */
+#define peekTransform(stack) (&(stack)->transforms[(stack)->depth - 1])
+
+//! A stack of transformation matrices.
+typedef struct {
+	Mat4_t *transforms; //! The stack's matrices, from the bottom up.
+	int depth; //! The number of matrices on the stack.
+	int capacity; //! The number of matrices ::transforms has room for.
+} TransformStack_t;
+
+/*
+ * @brief Allocate a ::TransformStack_t containing a single identity matrix.
+ *
+ * @return A pointer to the new ::TransformStack_t.
+ */
+TransformStack_t *createTransformStack(void);
+
+/*
+ * @brief Reset a ::TransformStack_t to a single identity matrix.
+ *
+ * @param stack The stack to reset; its storage is kept for reuse.
+ */
+void resetTransformStack(TransformStack_t *stack);
+
+/*
+ * @brief Push a copy of the top matrix onto a ::TransformStack_t.
+ *
+ * @param stack The stack to push onto.
+ */
+void pushTransform(TransformStack_t *stack);
+
+/*
+ * @brief Pop the top matrix off a ::TransformStack_t.
+ *
+ * The bottom matrix is never popped, so that the stack always has a top.
+ *
+ * @param stack The stack to pop.
+ */
+void popTransform(TransformStack_t *stack);
+
+/*
+ * @brief Multiply a transformation into the top of a ::TransformStack_t.
+ *
+ * The top matrix @a top becomes @f$top \cdot transform@f$, so @p transform is
+ * applied to points before any transformations already on the stack.
+ *
+ * @param stack The stack whose top matrix will be transformed.
+ * @param transform The transformation to multiply in.
+ */
+void multiplyTransform(TransformStack_t *stack, const Mat4_t *transform);
+
+/*
+ * @brief Deallocate a ::TransformStack_t.
+ *
+ * @param stack The stack to deallocate.
+ */
+void freeTransformStack(TransformStack_t *stack);
@@ -3,18 +3,29 @@
  *  @brief Unit-test functions used to perform regression testing.
  */
 
+#include <float.h>
+#include <limits.h>
 #include <ncurses.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
 #include <stdbool.h>
 
+#include "src/arena.h"
+#include "src/fast_math.h"
 #include "src/globals.h"
 #include "src/unit_tests.h"
+#include "src/graphics/camera.h"
+#include "src/graphics/cull.h"
+#include "src/graphics/curve.h"
 #include "src/graphics/geometry.h"
 #include "src/graphics/graphics.h"
 #include "src/graphics/matrix.h"
+#include "src/graphics/mesh.h"
 #include "src/graphics/screen.h"
+#include "src/graphics/tessellation.h"
+#include "src/graphics/tiles.h"
+#include "src/graphics/transform.h"
 
 /*!
  *  @brief Execute a unit-test function, and print an appropriate message.
@@ -23,7 +34,9 @@
  *  successfully (a return value of 1), or failed (return value of 0). If
  *  possible, display the success/failure message with an appropriate color,
  *  using the TERM_COLOR_* macros. On failure, set the variable ::exitStatus
- *  (defined in the using function's scope) to 0; otherwise, 1.
+ *  (defined in the using function's scope) to 1; otherwise, leave it as it
+ *  is, so that any failed test fails the run. Each test's ::g_frameArena
+ *  allocations are released after it runs, like a frame's.
  *
  *  @param func A unit-test function to run: must have a return value of 1 on
  *      success, and 0 on failure.
@@ -39,7 +52,8 @@
 			printf("Testing %-50s %s\n", #func ":",\
 				testResult?"Success.":"Failure.\tx");\
 		\
-		exitStatus = !testResult;\
+		exitStatus |= !testResult;\
+		resetArena(&g_frameArena);\
 	} while(0)
 
 /*!
@@ -117,6 +131,13 @@
 		return equalZBufs;\
 	} while(0);\
 
+//! The largest rounding error tolerated in floating-point comparisons.
+#ifdef SINGLE_PRECISION
+#define TEST_EPSILON 1e-4
+#else
+#define TEST_EPSILON 1e-9
+#endif
+
 //! The terminal escape code to set a foreground color for a success message.
 #define TERM_COLOR_SUCCESS "\033[38;5;34m"
 
@@ -137,6 +158,11 @@ extern ZBuffer_t *g_zbuffer;
  */
 static int testAddPoint(void);
 
+/*!
+ *  @brief Test matrix.h reserveMatrix() and expandMatrix().
+ */
+static int testReserveMatrix(void);
+
 /*!
  *  @brief Test matrix.h addEdge().
  */
@@ -157,6 +183,12 @@ static int testAddBezier(void);
  */
 static int testAddHermite(void);
 
+/*
+ * @brief Test that ::flattenBezier() and ::flattenHermite() stay within
+ *      ::CURVE_TOLERANCE of ::addBezier()'s and ::addHermite()'s samples.
+ */
+static int testFlattenCurves(void);
+
 /*!
  *  @brief Test matrix.h addRectangularPrism().
  */
@@ -172,6 +204,27 @@ static int testAddSphere(void);
  */
 static int testAddTorus(void);
 
+/*!
+ *  @brief Test mesh.h addMeshTriangle() and addMesh(), and geometry.h's mesh
+ *      generators.
+ */
+static int testAddMesh(void);
+
+/*!
+ *  @brief Test mesh.h transformMesh() and transform.h normalMat4().
+ */
+static int testTransformMesh(void);
+
+/*
+ * @brief Test that ::g_tessellationCache reuses, and evicts, primitives.
+ */
+static int testTessellationCache(void);
+
+/*
+ * @brief Test that ::circleSegments() tracks a primitive's size on screen.
+ */
+static int testLevelOfDetail(void);
+
 /*!
  *  @brief Test matrix.h multiplyScalar().
  */
@@ -207,6 +260,21 @@ static int testCreateRotation(void);
  */
 static int testCreateIdentity(void);
 
+/*!
+ *  @brief Test transform.h composeMat4() and applyMat4().
+ */
+static int testComposeMat4(void);
+
+/*!
+ *  @brief Test transform.h invertMat4().
+ */
+static int testInvertMat4(void);
+
+/*!
+ *  @brief Test that every transform.h vertex kernel gives identical results.
+ */
+static int testVertexKernels(void);
+
 /*!
  *  @brief Test matrix.h equalMatrix().
  */
@@ -223,26 +291,120 @@ static int testZBufferIO(void);
 */
 static int testDrawLine(void);
 
+/*
+ * @brief Test that ::graphics::drawLine() draws lines that reach far past the
+ *      screen as it did before they were clipped.
+*/
+static int testClippedLines(void);
+
 /*
  * @brief Test ::graphics::drawHorizontalGradientLine().
 */
 static int testDrawHorizontalGradientLine(void);
 
+/*
+ * @brief Test that ::graphics::drawHorizontalGradientLine() keeps a long
+ *      span's colors between its endpoints', clips it to ::g_clipRect
+ *      without changing the pixels it keeps, and draws at most the first
+ *      pixel of a span no longer than one.
+*/
+static int testGradientSpan(void);
+
 /*
  * @brief Test ::screen::scanlineRender().
  */
 static int testScanLineRender(void);
 
+/*
+ * @brief Test the edge rasterizer behind ::graphics::scanlineRender() against
+ *      the scanline rasterizer, and its fill rule.
+ */
+static int testEdgeRasterizer(void);
+
+/*
+ * @brief Test that the scanline rasterizer draws a zoomed-in scene, whose
+ *      triangles reach far past the screen, as it did before they were
+ *      clipped.
+ */
+static int testClippedScanlines(void);
+
+/*
+ * @brief Test that the edge rasterizer's guard band clips triangles without
+ *      cracks, overlaps, or changes to their colors.
+ */
+static int testGuardBand(void);
+
 /*
  * @brief Test ::screen::ZBuffer_t functionality.
  */
 static int testZBuffering(void);
 
+/*
+ * @brief Test that skipping triangles and blocks hidden in the coarse depth
+ *      of ::g_zbuffer doesn't change what's drawn, and that some are skipped.
+ */
+static int testDepthCulling(void);
+
+/*
+ * @brief Test that rendering on several threads with ::tiles::renderTiles()
+ *      is bit-identical to rendering on one, with either rasterizer.
+ */
+static int testTiledRendering(void);
+
+/*
+ * @brief Test the perspective projection, frustum culling and near-plane
+ *      clipping of camera.h.
+ */
+static int testCamera(void);
+
+/*
+ * @brief Test that ::cull::cullTriangles() culls each kind of triangle for the
+ *      right reason, that its kernels agree, and that culling doesn't change
+ *      what ::matrix::drawMatrix() draws.
+ */
+static int testCullTriangles(void);
+
+/*
+ * @brief Test that ::screen::clearZBuffer() leaves stale tiles to be emptied
+ *      as they're used, and that a frame drawn after it matches one drawn into
+ *      a new buffer, with either rasterizer and across the generation count's
+ *      wraparound.
+ */
+static int testLazyClear(void);
+
+/*
+ * @brief Test that ::screen::takeDirtyRects() covers every pixel changed by a
+ *      frame, and its clear, and nothing else, on a buffer with padded rows.
+ */
+static int testDirtyRects(void);
+
+/*
+ * @brief Test that ::screen::matchesColorPlane() only accepts 32-bit 0xRRGGBB
+ *      pixels, which the z-buffer can draw into directly.
+ */
+static int testScreenFormat(void);
+
 /*
  * @brief Test ::graphics::lightColor().
 */
 static int testLighting(void);
 
+/*
+ * @brief Test that the approximations of fast_math.h stay within their error
+ *      bounds of libm, and that exact mode is libm.
+*/
+static int testFastMath(void);
+
+/*
+ * @brief Test that a steady-state frame allocates only from ::g_frameArena.
+*/
+static int testFrameArena(void);
+
+/*
+ * @brief Test ::mesh::drawMesh(), with per-vertex lighting.
+*/
+static int testDrawMesh(void);
+
 /*
  * @brief Setup the environment for ::unitTests().
  *
@@ -251,6 +413,33 @@ static int testLighting(void);
 */
 static void configureTestingEnvironment();
 
+/*
+ * @brief Return the color of a pixel of a ::ZBuffer_t, or -1 if it's empty.
+ *
+ * @param zBuf The buffer.
+ * @param x The column of the pixel.
+ * @param y The row of the pixel.
+ */
+static int pixelColor(ZBuffer_t *zBuf, int x, int y);
+
+/*
+ * @brief Copy every pixel of a ::ZBuffer_t, and its coarse depth, into another
+ *      of the same size.
+ *
+ * @param copy The buffer to copy into.
+ * @param zBuf The buffer to copy.
+ */
+static void copyPixels(ZBuffer_t *copy, ZBuffer_t *zBuf);
+
+/*
+ * @brief Return whether two ::ZBuffer_t of the same size hold bit-identical
+ *      pixels.
+ *
+ * @param zBuf1 The first buffer.
+ * @param zBuf2 The second buffer.
+ */
+static int samePixels(ZBuffer_t *zBuf1, ZBuffer_t *zBuf2);
+
 static int testAddPoint(void){
 	Matrix_t * points = createMatrix();
 
@@ -265,6 +454,28 @@ static int testAddPoint(void){
 	ASSERT_EQUAL(points, "testAddPoint.csv");
 }
 
+static int testReserveMatrix(void){
+	Matrix_t * points = createMatrix();
+	reserveMatrix(points, 100);
+	int reserved = points->capacity >= 100 && points->numPoints == 0 &&
+		(size_t)points->points % MATRIX_ALIGNMENT == 0;
+
+	int point;
+	for(point = 0; point < 1000; point++)
+		addPoint(points, POINT(point, -point, 2 * point));
+
+	int preserved = points->numPoints == 1000 && points->capacity >= 1000;
+	for(point = 0; point < points->numPoints; point++)
+		if(points->points[point][X] != point ||
+			points->points[point][Y] != -point ||
+			points->points[point][Z] != 2 * point ||
+			points->points[point][W] != 1)
+			preserved = 0;
+
+	freeMatrix(points);
+	return reserved && preserved;
+}
+
 static int testAddEdge(void){
 	Matrix_t * points = createMatrix();
 	addEdge(points, POINT(0, 0, 0), POINT(100, 0, 100));
@@ -294,9 +505,62 @@ static int testAddHermite(void){
 	ASSERT_EQUAL(points, "testAddHermite.csv");
 }
 
+static int testFlattenCurves(void){
+	Matrix_t *samples = createMatrix(), *polyline = createMatrix();
+	addBezier(samples, POINT(200, 250), POINT(150, 50), POINT(300, 250),
+		POINT(300, 250));
+	flattenBezier(polyline, POINT(200, 250), POINT(150, 50), POINT(300, 250),
+		POINT(300, 250));
+	int bezierSegments = polyline->numPoints - 1;
+
+	addHermite(samples, POINT(150, 150), POINT(150, 50), POINT(350, 150),
+		POINT(350, 300));
+	flattenHermite(polyline, POINT(150, 150), POINT(150, 50),
+		POINT(350, 150), POINT(350, 300));
+
+	// every sample must lie within the tolerance of some segment of its
+	// curve's polyline; addHermite()'s single precision costs a little slack
+	int close = 1, sample;
+	for(sample = 0; sample < samples->numPoints; sample++){
+		Point_t *pt = samples->points[sample];
+		int first = (sample < CURVE_STEP_NUMBER)?0:bezierSegments + 1,
+			last = (sample < CURVE_STEP_NUMBER)?bezierSegments:
+				polyline->numPoints - 1;
+
+		Point_t nearest = FLT_MAX;
+		int segment;
+		for(segment = first; segment < last; segment++){
+			Point_t *a = polyline->points[segment],
+				*b = polyline->points[segment + 1];
+			Point_t dx = b[X] - a[X], dy = b[Y] - a[Y],
+				lengthSquared = dx * dx + dy * dy,
+				// a zero-length segment's only point is its start
+				t = (lengthSquared > 0)?((pt[X] - a[X]) * dx +
+					(pt[Y] - a[Y]) * dy) / lengthSquared:0;
+			t = (t < 0)?0:(1 < t)?1:t;
+
+			Point_t ex = a[X] + t * dx - pt[X], ey = a[Y] + t * dy - pt[Y],
+				distance = sqrt(ex * ex + ey * ey);
+			if(distance < nearest)
+				nearest = distance;
+		}
+		close = close && nearest <= CURVE_TOLERANCE + 0.01;
+	}
+
+	// a straight, short curve needs a single segment
+	int numCurved = polyline->numPoints;
+	flattenBezier(polyline, POINT(0, 0), POINT(4, 0), POINT(8, 0),
+		POINT(12, 0));
+	int compact = polyline->numPoints == numCurved + 2 &&
+		numCurved < CURVE_STEP_NUMBER / 10;
+
+	freeMatrices(2, samples, polyline);
+	return close && compact;
+}
+
 static int testAddRectangularPrism(void){
 	Matrix_t * points = createMatrix();
-	addRectangularPrism(points, POINT(0, 0, 0), (double[]){100, 200, 300});
+	addRectangularPrism(points, POINT(0, 0, 0), (Point_t[]){100, 200, 300});
 	ASSERT_EQUAL(points, "testAddRectangularPrism.csv");
 }
 
@@ -315,6 +579,118 @@ static int testAddTorus(void){
 	ASSERT_EQUAL(points, "testAddTorus.csv");
 }
 
+static int testAddMesh(void){
+	Mesh_t *mesh = createMesh();
+	addRectangularPrismMesh(mesh, POINT(0, 0, 0), (Point_t[]){100, 200, 300});
+	int shared = mesh->vertices->numPoints == 8 && mesh->numIndices == 36;
+
+	clearMesh(mesh);
+	addSphereMesh(mesh, POINT(0, 0), 100);
+	addSphereMesh(mesh, POINT(100, 0), 50);
+	addSphereMesh(mesh, POINT(100, 100), 50);
+	shared = shared && 3 * mesh->vertices->numPoints < mesh->numIndices;
+
+	Matrix_t * points = createMatrix();
+	addMesh(points, mesh);
+	freeMesh(mesh);
+	if(!shared){
+		freeMatrix(points);
+		return 0;
+	}
+	ASSERT_EQUAL(points, "testAddSphere.csv");
+}
+
+static int testTransformMesh(void){
+	Mesh_t *mesh = createMesh();
+	addSphereMesh(mesh, POINT(0, 0, 0), 50);
+	Mat4_t scale = scaleMat4(POINT(2, 3, 4));
+	transformMesh(&scale, mesh);
+
+	// the normal of the ellipsoid (x/2)^2 + (y/3)^2 + (z/4)^2 = 50^2 at
+	// (x, y, z) is parallel to (x/4, y/9, z/16)
+	int equal = 1, vertex;
+	for(vertex = 0; vertex < mesh->vertices->numPoints; vertex++){
+		Point_t *pt = mesh->vertices->points[vertex],
+			*normal = mesh->normals->points[vertex];
+		Point_t gradient[3] = {pt[X] / 4, pt[Y] / 9, pt[Z] / 16};
+		Point_t length = sqrt(gradient[X] * gradient[X] +
+			gradient[Y] * gradient[Y] + gradient[Z] * gradient[Z]);
+
+		int coord;
+		for(coord = 0; coord < 3; coord++)
+			if(fabs(normal[coord] - gradient[coord] / length) > TEST_EPSILON)
+				equal = 0;
+	}
+
+	freeMesh(mesh);
+	return equal;
+}
+
+static int testTessellationCache(void){
+	TessellationCache_t *cache = &g_tessellationCache;
+	clearTessellationCache(cache);
+	long hits = cache->hits, misses = cache->misses,
+		evictions = cache->evictions;
+
+	Mesh_t *mesh = createMesh();
+	addTorusMesh(mesh, POINT(0, 0, 0), 20, 100);
+	int numVertices = mesh->vertices->numPoints;
+	addTorusMesh(mesh, POINT(10, 20, 30), 20, 100);
+	int reused = cache->hits == hits + 1 && cache->misses == misses + 1 &&
+		mesh->vertices->numPoints == 2 * numVertices;
+
+	int vertex;
+	for(vertex = 0; vertex < numVertices; vertex++){
+		Point_t *pt = mesh->vertices->points[vertex],
+			*copy = mesh->vertices->points[numVertices + vertex];
+		reused = reused && copy[X] == pt[X] + 10 && copy[Y] == pt[Y] + 20 &&
+			copy[Z] == pt[Z] + 30;
+	}
+
+	// a cache with room for one torus must evict it to make room for another
+	size_t capacity = cache->capacity;
+	cache->capacity = cache->size;
+	addTorusMesh(mesh, POINT(0, 0, 0), 30, 100);
+	int evicted = cache->evictions == evictions + 1 &&
+		cache->head == cache->tail && cache->head->key.rad1 == 30;
+	addTorusMesh(mesh, POINT(0, 0, 0), 20, 100);
+	evicted = evicted && cache->misses == misses + 3;
+
+	cache->capacity = capacity;
+	freeMesh(mesh);
+	return reused && evicted;
+}
+
+static int testLevelOfDetail(void){
+	Mat4_t identity = identityMat4(),
+		shrink = scaleMat4(POINT(0.1, 0.1, 0.1)),
+		deep = scaleMat4(POINT(1, 1, 10)),
+		grow = scaleMat4(POINT(1e3, 1e3, 1e3));
+
+	// the fewest segments within tolerance of a circle of radius 100
+	int segments = circleSegments(100, &identity);
+	double tolerance = g_levelOfDetail.tolerance;
+	int chosen = segments % 2 == 0 &&
+		100 * (1 - cos(M_PI / segments)) <= tolerance &&
+		100 * (1 - cos(M_PI / (segments - 2))) > tolerance;
+
+	// scaling along z doesn't change a primitive's size on the screen
+	int scaled = circleSegments(100, &deep) == segments &&
+		circleSegments(100, &shrink) < segments &&
+		circleSegments(1, &identity) == g_levelOfDetail.minSegments &&
+		circleSegments(100, &grow) == g_levelOfDetail.maxSegments;
+
+	Mesh_t *near = createMesh(), *far = createMesh();
+	addSphereMeshLOD(near, POINT(0, 0, 0), 100, &identity);
+	addSphereMeshLOD(far, POINT(0, 0, 0), 100, &shrink);
+	int cheaper = far->numIndices < near->numIndices &&
+		near->numIndices == 6 * segments * (segments / 2 - 1);
+
+	freeMesh(near);
+	freeMesh(far);
+	return chosen && scaled && cheaper;
+}
+
 static int testMultiplyScalar(void){
 	Matrix_t * points = createMatrix();
 	addPoint(points, POINT(11, 22, 33));
@@ -389,6 +765,10 @@ static int testMultiplyMatrices(void){
 
 	multiplyMatrices(3, m3, m4, m5);
 	int result2 = equalMatrix(m5, product2);
+
+	// a lone matrix is left as it is
+	multiplyMatrices(1, m5);
+	result2 = result2 && equalMatrix(m5, product2);
 	freeMatrices(4, m3, m4, m5, product2);
 
 	return result1 && result2;
@@ -429,7 +809,7 @@ static int testCreateRotation(void){
 		* rotX = createRotation(X_AXIS, 270),
 		* rotY = createRotation(Y_AXIS, 30),
 		* rotZ = createRotation(Z_AXIS, 45);
-	addRectangularPrism(points, POINT(0, 0, 0), (double[]){20, 100, 300});
+	addRectangularPrism(points, POINT(0, 0, 0), (Point_t[]){20, 100, 300});
 	multiplyMatrices(4, rotX, rotY, rotZ, points);
 	freeMatrices(3, rotX, rotY, rotZ);
 	ASSERT_EQUAL(points, "testCreateRotation.csv");
@@ -449,6 +829,79 @@ static int testCreateIdentity(void){
 	return result;
 }
 
+static int testComposeMat4(void){
+	Mat4_t rotX = rotationMat4(X_AXIS, 270),
+		rotY = rotationMat4(Y_AXIS, 30),
+		rotZ = rotationMat4(Z_AXIS, 45);
+	Mat4_t rotXY = composeMat4(&rotY, &rotX);
+	Mat4_t rotXYZ = composeMat4(&rotZ, &rotXY);
+
+	Matrix_t * points = createMatrix();
+	addRectangularPrism(points, POINT(0, 0, 0), (Point_t[]){20, 100, 300});
+	applyMat4(&rotXYZ, points);
+	ASSERT_EQUAL(points, "testCreateRotation.csv");
+}
+
+static int testInvertMat4(void){
+	Mat4_t rotation = rotationMat4(Y_AXIS, 30),
+		translation = translationMat4(POINT(-50, 100, 25)),
+		scale = scaleMat4(POINT(2, 3, 4));
+	Mat4_t transform = composeMat4(&rotation, &scale);
+	transform = composeMat4(&translation, &transform);
+
+	Mat4_t inverse;
+	if(!invertMat4(&transform, &inverse))
+		return 0;
+
+	Mat4_t product = composeMat4(&transform, &inverse),
+		identity = identityMat4();
+	int row, col;
+	for(col = 0; col < 4; col++)
+		for(row = 0; row < 4; row++)
+			if(fabs(product.cols[col][row] - identity.cols[col][row]) >
+				TEST_EPSILON)
+				return 0;
+
+	Mat4_t singular = scaleMat4(POINT(1, 0, 1));
+	return !invertMat4(&singular, &inverse);
+}
+
+static int testVertexKernels(void){
+	Mat4_t rotX = rotationMat4(X_AXIS, 270),
+		rotY = rotationMat4(Y_AXIS, 30),
+		translation = translationMat4(POINT(-50, 100, 25));
+	Mat4_t transform = composeMat4(&rotY, &rotX);
+	transform = composeMat4(&translation, &transform);
+
+	Matrix_t * reference = createMatrix();
+	addSphere(reference, POINT(0, 0), 50);
+	Matrix_t * original = copyMatrix(reference);
+
+	setVertexKernel(VERTEX_KERNEL_SCALAR);
+	applyMat4(&transform, reference);
+
+	int equal = 1, kernel;
+	for(kernel = VERTEX_KERNEL_SCALAR; kernel <= VERTEX_KERNEL_AVX; kernel++){
+		if(!setVertexKernel(kernel))
+			continue;
+
+		Matrix_t * points = copyMatrix(original);
+		applyMat4(&transform, points);
+
+		int point, coord;
+		for(point = 0; point < points->numPoints; point++)
+			for(coord = 0; coord < 4; coord++)
+				if(fabs(points->points[point][coord] -
+					reference->points[point][coord]) > TEST_EPSILON)
+					equal = 0;
+		freeMatrix(points);
+	}
+
+	setVertexKernel(VERTEX_KERNEL_AUTO);
+	freeMatrices(2, reference, original);
+	return equal;
+}
+
 static int testEqualMatrix(void){
 	Matrix_t * m1 = createMatrix();
 	addPoint(m1, POINT(11, 22, 33));
@@ -483,6 +936,16 @@ static int testDrawLine(void){
 	ASSERT_EQUAL_SCREEN("testDrawLine.csv");
 }
 
+static int testClippedLines(void){
+	drawLine(POINT(-4000, -3000, 5), POINT(3500, 2800, 5), 0xFF0000);
+	drawLine(POINT(-100.5, -5000, 6), POINT(120.25, 4000, 6), 0x00FF00);
+	drawLine(POINT(3000, 100, 7), POINT(-3000, -120, 7), 0x0000FF);
+	drawLine(POINT(-3000, 3000), POINT(3000, 2900), 0xFFFF00);
+	drawLine(POINT(10, 10), POINT(40, 60), 0xFFFFFF);
+	drawLine(POINT(-600, 200, 8), POINT(-200, -600, 8), 0x00FFFF);
+	ASSERT_EQUAL_SCREEN("testClippedLines.csv");
+}
+
 static int testDrawHorizontalGradientLine(void){
 	drawHorizontalGradientLine(
 		&(Light_t){
@@ -497,6 +960,53 @@ static int testDrawHorizontalGradientLine(void){
 	ASSERT_EQUAL_SCREEN("testDrawHorizontalGradientLine.csv");
 }
 
+static int testGradientSpan(void){
+	Light_t left = {
+		.color = RGB(0xFF, 0x00, 0x80),
+		.pos = POINT(-1000.3, 10.5, 3)
+	}, right = {
+		.color = RGB(0x00, 0xFF, 0x80),
+		.pos = POINT(1000.6, 10.5, 3)
+	};
+	int y = 10 + g_screenHeight / 2;
+
+	drawHorizontalGradientLine(&left, &right);
+	int *unclipped = malloc(g_screenWidth * sizeof(int));
+	int x, valid = 1;
+	for(x = 0; x < g_screenWidth; x++){
+		unclipped[x] = pixelColor(g_zbuffer, x, y);
+		int red = unclipped[x] >> 16, green = (unclipped[x] >> 8) & 0xFF;
+		valid = valid && unclipped[x] != -1 && (unclipped[x] & 0xFF) == 0x80 &&
+			(x == 0 || red <= unclipped[x - 1] >> 16) &&
+			abs(red + green - 0xFF) <= 1;
+	}
+	clearZBuffer(g_zbuffer);
+
+	PixelRect_t screen = g_clipRect;
+	g_clipRect = (PixelRect_t){101, 0, 300, g_screenHeight - 1};
+	drawHorizontalGradientLine(&right, &left);
+	g_clipRect = screen;
+	for(x = 0; x < g_screenWidth; x++)
+		valid = valid && pixelColor(g_zbuffer, x, y) ==
+			((101 <= x && x <= 300)?unclipped[x]:-1);
+	clearZBuffer(g_zbuffer);
+
+	// a span of no length draws nothing, and a far shorter one only its first
+	// pixel, without dividing its colors by its length
+	left.pos = POINT(0, 10.5, 3);
+	right.pos = POINT(0, 10.5, 3);
+	drawHorizontalGradientLine(&left, &right);
+	right.pos = POINT(1e-20, 10.5, 3);
+	drawHorizontalGradientLine(&left, &right);
+	for(x = 0; x < g_screenWidth; x++)
+		valid = valid && pixelColor(g_zbuffer, x, y) ==
+			((x == g_screenWidth / 2)?0xFF0080:-1);
+	clearZBuffer(g_zbuffer);
+
+	free(unclipped);
+	return valid;
+}
+
 static int testScanLineRender(void){
 	scanlineRender(
 			&(Light_t){
@@ -514,6 +1024,155 @@ static int testScanLineRender(void){
 	ASSERT_EQUAL_SCREEN("testScanLineRender.csv");
 }
 
+static int testClippedScanlines(void){
+	Matrix_t *points = createMatrix();
+	addSphere(points, POINT(30, -1780, 0), 1500);
+	addSphere(points, POINT(-1950, 200, 0), 1700);
+	drawMatrix(points);
+	freeMatrix(points);
+	ASSERT_EQUAL_SCREEN("testClippedScanlines.csv");
+}
+
+static int testGuardBand(void){
+	int *coverage = calloc(g_screenWidth * g_screenHeight, sizeof(int));
+	int y, x, valid = 1;
+
+	// a quad thousands of screens wide, split in two, covers every pixel
+	// exactly once
+	Point_t quad[][4] = {
+		{-5e6, -4e6, 0, 1}, {6e6, -5e6, 0, 1}, {5e6, 4e6, 0, 1},
+		{-4e6, 6e6, 0, 1}
+	};
+	g_rasterizer = RASTERIZER_EDGE;
+	int half;
+	for(half = 0; half < 2; half++){
+		scanlineRender(
+			&(Light_t){.color = RGB(0x80, 0x40, 0x20), .pos = quad[0]},
+			&(Light_t){.color = RGB(0x80, 0x40, 0x20), .pos = quad[half + 1]},
+			&(Light_t){.color = RGB(0x80, 0x40, 0x20), .pos = quad[half + 2]});
+		for(y = 0; y < g_screenHeight; y++)
+			for(x = 0; x < g_screenWidth; x++)
+				if(pixelColor(g_zbuffer, x, y) != -1){
+					coverage[y * g_screenWidth + x]++;
+					valid = valid && pixelColor(g_zbuffer, x, y) == 0x804020;
+				}
+		clearZBuffer(g_zbuffer);
+	}
+	for(y = 0; y < g_screenWidth * g_screenHeight; y++)
+		valid = valid && coverage[y] == 1;
+
+	// a sliver reaching past the guard band covers what the scanline
+	// rasterizer does, but for pixels along its edges
+	int rasterizer, covered = 0, disputed = 0;
+	memset(coverage, 0, g_screenWidth * g_screenHeight * sizeof(int));
+	for(rasterizer = RASTERIZER_SCANLINE; rasterizer <= RASTERIZER_EDGE;
+		rasterizer++){
+		g_rasterizer = rasterizer;
+		scanlineRender(
+			&(Light_t){.color = RGB(0xFF, 0, 0), .pos = POINT(-200, -100, 1)},
+			&(Light_t){.color = RGB(0, 0xFF, 0), .pos = POINT(-200, 120, 1)},
+			&(Light_t){.color = RGB(0, 0, 0xFF), .pos = POINT(4e6, 3e6, 1)});
+		for(y = 0; y < g_screenHeight; y++)
+			for(x = 0; x < g_screenWidth; x++)
+				coverage[y * g_screenWidth + x] +=
+					(pixelColor(g_zbuffer, x, y) != -1) << rasterizer;
+		clearZBuffer(g_zbuffer);
+	}
+	g_rasterizer = RASTERIZER_SCANLINE;
+	for(y = 0; y < g_screenWidth * g_screenHeight; y++){
+		covered += coverage[y] != 0;
+		disputed += coverage[y] == 1 || coverage[y] == 2;
+	}
+	free(coverage);
+
+	return valid && covered > 0 && disputed <= covered * 0.02;
+}
+
+static int testEdgeRasterizer(void){
+	ZBuffer_t *scanline = readZBufferFromFile("testScanLineRender.csv");
+	if(scanline == NULL)
+		return 0;
+
+	g_rasterizer = RASTERIZER_EDGE;
+	scanlineRender(
+			&(Light_t){
+				.color = RGB(0xFF, 0x00, 0x00),
+				.pos = POINT(0, 0, 5)
+			},
+			&(Light_t){
+				.color = RGB(0x00, 0xFF, 0x00),
+				.pos = POINT(100, 200, 10)
+			},
+			&(Light_t){
+				.color = RGB(0x00, 0x00, 0xFF),
+				.pos = POINT(130, -30, 20)
+			});
+
+	// the rasterizers may only disagree on pixels along the triangle's edges,
+	// and on the rounding of their colors
+	int covered = 0, disputed = 0, colorError = 0;
+	int y, x;
+	for(y = 0; y < g_screenHeight; y++)
+		for(x = 0; x < g_screenWidth; x++){
+			int color1 = pixelColor(g_zbuffer, x, y),
+				color2 = pixelColor(scanline, x, y);
+			if(color1 == -1 && color2 == -1)
+				continue;
+			covered++;
+
+			if(color1 == -1 || color2 == -1){
+				disputed++;
+				continue;
+			}
+
+			int shift;
+			for(shift = 0; shift < 24; shift += 8){
+				int error = abs(((color1 >> shift) & 0xFF) -
+					((color2 >> shift) & 0xFF));
+				colorError = (error > colorError)?error:colorError;
+			}
+		}
+	freeZBuffer(scanline);
+	clearZBuffer(g_zbuffer);
+
+	// a fan of triangles around an off-center point tiles a rectangle of
+	// 100x60 pixels, and shares edges at many angles: each pixel must be
+	// covered exactly once
+	Point_t fan[][4] = {
+		{-50, -30, 0, 1}, {10, -30, 0, 1}, {50, -30, 0, 1}, {50, 7, 0, 1},
+		{50, 30, 0, 1}, {-20, 30, 0, 1}, {-50, 30, 0, 1}, {-50, -5, 0, 1}
+	};
+	int numFan = sizeof(fan) / sizeof(fan[0]);
+	int *coverage = calloc(g_screenWidth * g_screenHeight, sizeof(int));
+	int tiled = 1, point;
+	for(point = 0; point < numFan; point++){
+		scanlineRender(
+			&(Light_t){.color = RGB(0xFF, 0xFF, 0xFF), .pos = POINT(3.3, -2.7)},
+			&(Light_t){.color = RGB(0xFF, 0xFF, 0xFF), .pos = fan[point]},
+			&(Light_t){
+				.color = RGB(0xFF, 0xFF, 0xFF),
+				.pos = fan[(point + 1) % numFan]
+			});
+
+		for(y = 0; y < g_screenHeight; y++)
+			for(x = 0; x < g_screenWidth; x++)
+				if(pixelColor(g_zbuffer, x, y) != -1)
+					coverage[y * g_screenWidth + x]++;
+		clearZBuffer(g_zbuffer);
+	}
+	g_rasterizer = RASTERIZER_SCANLINE;
+
+	int total = 0;
+	for(y = 0; y < g_screenHeight * g_screenWidth; y++){
+		tiled = tiled && coverage[y] <= 1;
+		total += coverage[y];
+	}
+	free(coverage);
+
+	return disputed <= covered * 0.02 && colorError <= 2 && tiled &&
+		total == 100 * 60;
+}
+
 static int testZBuffering(void){
 	Matrix_t *pts = createMatrix();
 	addRectangularPrism(pts, POINT(0, 0, 300), POINT(20, 40, 60));
@@ -524,11 +1183,487 @@ static int testZBuffering(void){
 	ASSERT_EQUAL_SCREEN("testZBuffering.csv");
 }
 
+static int testDepthCulling(void){
+	Matrix_t *points = createMatrix();
+	addRectangularPrism(points, POINT(0, 0, 300), POINT(20, 40, 60));
+	addSphere(points, POINT(0, 0, 0), 80);
+	addTorus(points, POINT(20, 20, 200), 30, 20);
+
+	ZBuffer_t *expected = readZBufferFromFile("testZBuffering.csv");
+	if(expected == NULL)
+		return 0;
+
+	g_depthStats = (DepthStats_t){0};
+	drawMatrix(points);
+	int unchanged = equalZBuffers(g_zbuffer, expected);
+	DepthStats_t scanline = g_depthStats;
+	clearZBuffer(g_zbuffer);
+	freeZBuffer(expected);
+
+	// the edge rasterizer, without and then with the coarse depth test
+	g_rasterizer = RASTERIZER_EDGE;
+	g_depthCulling = 0;
+	drawMatrix(points);
+	ZBuffer_t *unculled = createZBuffer();
+	copyPixels(unculled, g_zbuffer);
+	clearZBuffer(g_zbuffer);
+
+	g_depthCulling = 1;
+	g_depthStats = (DepthStats_t){0};
+	drawMatrix(points);
+	DepthStats_t edge = g_depthStats;
+	unchanged = unchanged && samePixels(g_zbuffer, unculled);
+	clearZBuffer(g_zbuffer);
+	g_rasterizer = RASTERIZER_SCANLINE;
+
+	freeZBuffer(unculled);
+	freeMatrix(points);
+	return unchanged && scanline.trianglesRejected > 0 &&
+		edge.trianglesRejected + edge.blocksRejected > 0;
+}
+
+static int testTiledRendering(void){
+	Matrix_t *points = createMatrix();
+	addRectangularPrism(points, POINT(0, 0, 300), POINT(20, 40, 60));
+	addSphere(points, POINT(0, 0, 0), 80);
+	addTorus(points, POINT(20, 20, 200), 30, 20);
+	// a box larger than the screen, which straddles every tile's edges
+	addRectangularPrism(points, POINT(-900, 700, -500), POINT(1800, 1400, 100));
+	Mesh_t *mesh = createMesh();
+	addSphereMesh(mesh, POINT(-40, 30, 100), 60);
+
+	ZBuffer_t *expected = createZBuffer();
+	int identical = 1, rasterizer;
+	for(rasterizer = RASTERIZER_SCANLINE; rasterizer <= RASTERIZER_EDGE;
+		rasterizer++){
+		g_rasterizer = rasterizer;
+
+		int threads;
+		for(threads = 1; threads <= 5; threads += 2){
+			g_renderThreads = threads;
+			drawMatrix(points);
+			drawMesh(mesh);
+
+			if(threads == 1)
+				copyPixels(expected, g_zbuffer);
+			else
+				identical = identical && samePixels(g_zbuffer, expected);
+			clearZBuffer(g_zbuffer);
+		}
+	}
+	g_rasterizer = RASTERIZER_SCANLINE;
+	g_renderThreads = 1;
+	stopRenderThreads();
+
+	freeZBuffer(expected);
+	freeMatrix(points);
+	freeMesh(mesh);
+	return identical;
+}
+
+static int testCamera(void){
+	// seen from the focal length, the z = 0 plane keeps its orthographic size
+	// and depth, and the plane as far again is drawn at half the size
+	Camera_t camera = perspectiveCamera(POINT(0, 0, 500), POINT(0, 0, 0), 0);
+	Point_t onPlane[4], far[4], near[4];
+	int projected = projectPoint(&camera, POINT(120, -80, 0), onPlane) &&
+		projectPoint(&camera, POINT(120, -80, -500), far) &&
+		!projectPoint(&camera, POINT(0, 0, 499.5), near) &&
+		onPlane[X] == 120 && onPlane[Y] == -80 && onPlane[Z] == 0 &&
+		far[X] == 60 && far[Y] == -40 && far[Z] < onPlane[Z] && near[W] == 0;
+
+	// spheres behind the eye or beside the frustum are culled; distant ones
+	// are tessellated more coarsely
+	Camera_t orthographic = orthographicCamera();
+	Mat4_t identity = identityMat4(), lod,
+		lower = translationMat4(POINT(0, -700, 0));
+	int culled = sphereInView(&camera, POINT(0, 0, 480), 50, &identity, &lod) &&
+		!sphereInView(&camera, POINT(0, 0, 600), 50, &identity, &lod) &&
+		!sphereInView(&camera, POINT(2000, 0, 0), 50, &identity, &lod) &&
+		sphereInView(&camera, POINT(2000, 0, -2500), 50, &identity, &lod) &&
+		!sphereInView(&orthographic, POINT(0, 1000), 50, &identity, &lod) &&
+		sphereInView(&orthographic, POINT(0, 1000), 50, &lower, &lod);
+	sphereInView(&camera, POINT(0, 0, 0), 50, &identity, &lod);
+	int nearSegments = circleSegments(50, &lod);
+	sphereInView(&camera, POINT(0, 0, -4500), 50, &identity, &lod);
+	int tessellated = circleSegments(50, &lod) < nearSegments;
+
+	// a square in the z = 0 plane is drawn exactly as without a camera
+	Matrix_t *points = createMatrix();
+	addPoint(points, POINT(-100, -100, 0));
+	addPoint(points, POINT(100, -100, 0));
+	addPoint(points, POINT(100, 100, 0));
+	addPoint(points, POINT(-100, -100, 0));
+	addPoint(points, POINT(100, 100, 0));
+	addPoint(points, POINT(-100, 100, 0));
+
+	ZBuffer_t *expected = createZBuffer();
+	int identical = 1, pass, y, x;
+	for(pass = 0; pass < 2; pass++){
+		g_camera = pass?camera:orthographic;
+		drawMatrix(points);
+		if(!pass)
+			copyPixels(expected, g_zbuffer);
+		else
+			identical = samePixels(g_zbuffer, expected);
+		clearZBuffer(g_zbuffer);
+	}
+	freeZBuffer(expected);
+
+	// a square reaching past the eye is clipped at the near plane, and one
+	// behind it isn't drawn at all
+	CLEAR(points);
+	addPoint(points, POINT(-300, -300, -500));
+	addPoint(points, POINT(300, -300, -500));
+	addPoint(points, POINT(300, 300, 1000));
+	addPoint(points, POINT(-300, -300, -500));
+	addPoint(points, POINT(300, 300, 1000));
+	addPoint(points, POINT(-300, 300, 1000));
+	drawMatrix(points);
+	Point_t nearest = camera.focal * (camera.focal / CAMERA_NEAR_PLANE - 1);
+	int drawn = 0, clipped = 1;
+	for(y = 0; y < g_screenHeight; y++)
+		for(x = 0; x < g_screenWidth; x++)
+			if(pixelColor(g_zbuffer, x, y) != -1){
+				float depth = g_zbuffer->depth[ZBUFFER_PIXEL(g_zbuffer, x, y)];
+				drawn++;
+				clipped = clipped && -camera.focal < depth && depth <= nearest;
+			}
+	clearZBuffer(g_zbuffer);
+
+	drawTriangle(POINT(-300, -300, 700), POINT(300, -300, 700),
+		POINT(300, 300, 900));
+	int hidden = 1;
+	for(y = 0; y < g_screenHeight; y++)
+		for(x = 0; x < g_screenWidth; x++)
+			hidden = hidden && pixelColor(g_zbuffer, x, y) == -1;
+
+	g_camera = orthographicCamera();
+	freeMatrix(points);
+	return projected && culled && tessellated && identical &&
+		drawn > g_screenWidth * g_screenHeight / 4 && clipped && hidden;
+}
+
+static int testCullTriangles(void){
+	// one triangle of each kind; the sliver within a row of pixels falls
+	// between the scanline rasterizer's rows, and the one straddling a row
+	// boundary between the edge rasterizer's pixel centers
+	Point_t batch[][4] = {
+		{-100, -100, 0, 1}, {100, -100, 0, 1}, {0, 100, 0, 1},
+		{-100, -100, 0, 1}, {0, 100, 0, 1}, {100, -100, 0, 1},
+		{-100, -100, 0, 1}, {0, 0, 0, 1}, {100, 100, 0, 1},
+		{2000, -100, 0, 1}, {2200, -100, 0, 1}, {2100, 100, 0, 1},
+		{0, 0.1, 0, 1}, {5, 0.2, 0, 1}, {2, 0.9, 0, 1},
+		{0, 0.6, 0, 1}, {5, 0.7, 0, 1}, {2, 1.4, 0, 1},
+		{-100, -100, 0, 0}, {0, 100, 0, 1}, {100, -100, 0, 1}
+	};
+	int survivors[7], numSurvivors;
+
+	g_cullStats = (CullStats_t){0};
+	numSurvivors = cullTriangles(batch, NULL, 7, survivors);
+	int scanline = numSurvivors == 3 && survivors[0] == 0 &&
+		survivors[1] == 5 && survivors[2] == 6 &&
+		g_cullStats.triangles == 6 &&
+		g_cullStats.culled[CULL_BACKFACE] == 1 &&
+		g_cullStats.culled[CULL_DEGENERATE] == 1 &&
+		g_cullStats.culled[CULL_OFFSCREEN] == 1 &&
+		g_cullStats.culled[CULL_SUBPIXEL] == 1;
+
+	g_rasterizer = RASTERIZER_EDGE;
+	int indices[] = {15, 16, 17, 12, 13, 14, 0, 1, 2};
+	numSurvivors = cullTriangles(batch, indices, 3, survivors);
+	int edge = numSurvivors == 2 && survivors[0] == 1 && survivors[1] == 2 &&
+		g_cullStats.triangles == 9 && g_cullStats.culled[CULL_SUBPIXEL] == 2;
+
+	// triangles of every size, scattered on and off the screen
+	Matrix_t *points = createMatrix();
+	srand(21);
+	int triangle, vertex;
+	for(triangle = 0; triangle < 3000; triangle++){
+		Point_t x = rand() % 2400 - 1200, y = rand() % 2000 - 1000,
+			size = (triangle % 3 == 0)?rand() % 200:(rand() % 300) / 100.0;
+		for(vertex = 0; vertex < 3; vertex++)
+			addPoint(points, POINT(x + size * (rand() % 200 - 100) / 100,
+				y + size * (rand() % 200 - 100) / 100, rand() % 100));
+	}
+	int *expected = malloc(3000 * sizeof(int)),
+		*culled = malloc(3000 * sizeof(int));
+
+	int agree = 1, kernel, rasterizer;
+	for(rasterizer = RASTERIZER_SCANLINE; rasterizer <= RASTERIZER_EDGE;
+		rasterizer++){
+		g_rasterizer = rasterizer;
+		setCullKernel(CULL_KERNEL_SCALAR);
+		int numExpected = cullTriangles(points->points, NULL, 3000, expected);
+		for(kernel = CULL_KERNEL_SCALAR; kernel <= CULL_KERNEL_SSE2; kernel++){
+			if(!setCullKernel(kernel))
+				continue;
+			agree = agree && cullTriangles(points->points, NULL, 3000,
+				culled) == numExpected && !memcmp(culled, expected,
+				numExpected * sizeof(int));
+		}
+		setCullKernel(CULL_KERNEL_AUTO);
+
+		// drawn one at a time, without the culling stage, the triangles
+		// leave the same pixels
+		ZBuffer_t *reference = createZBuffer();
+		int pass;
+		for(pass = 0; pass < 2; pass++){
+			if(pass)
+				drawMatrix(points);
+			else
+				for(vertex = 0; vertex < points->numPoints; vertex += 3)
+					drawTriangle(points->points[vertex],
+						points->points[vertex + 1], points->points[vertex + 2]);
+			if(!pass)
+				copyPixels(reference, g_zbuffer);
+			else
+				agree = agree && samePixels(g_zbuffer, reference);
+			clearZBuffer(g_zbuffer);
+		}
+		freeZBuffer(reference);
+	}
+	g_rasterizer = RASTERIZER_SCANLINE;
+
+	free(expected);
+	free(culled);
+	freeMatrix(points);
+	return scanline && edge && agree;
+}
+
+static int testLazyClear(void){
+	// a frame that covers most of the screen, then a small sprite behind it
+	Matrix_t *background = createMatrix(), *sprite = createMatrix();
+	addSphere(background, POINT(0, 0, 200), 300);
+	addRectangularPrism(sprite, POINT(-20, 20, 0), POINT(40, 40, 40));
+	int staleX = g_screenWidth / 2 + 200, staleY = g_screenHeight / 2,
+		stale = ZBUFFER_PIXEL(g_zbuffer, staleX, staleY);
+
+	ZBuffer_t *screen = g_zbuffer;
+	int rasterizer, identical = 1, lazy = 1;
+	for(rasterizer = RASTERIZER_SCANLINE; rasterizer <= RASTERIZER_EDGE;
+		rasterizer++){
+		g_rasterizer = rasterizer;
+		ZBuffer_t *expected = createZBuffer();
+		g_zbuffer = expected;
+		drawMatrix(sprite);
+		drawLine(POINT(-100, -100, 0), POINT(100, -50, 0));
+		g_zbuffer = screen;
+
+		// the sprite's tiles mustn't keep the background's depth either
+		drawMatrix(background);
+		clearZBuffer(g_zbuffer);
+		lazy = lazy && g_zbuffer->depth[stale] != ZBUFFER_EMPTY &&
+			pixelColor(g_zbuffer, staleX, staleY) == -1;
+		drawMatrix(background);
+		clearZBuffer(g_zbuffer);
+		drawMatrix(sprite);
+		drawLine(POINT(-100, -100, 0), POINT(100, -50, 0));
+		identical = identical && samePixels(g_zbuffer, expected);
+		clearZBuffer(g_zbuffer);
+		freeZBuffer(expected);
+	}
+	g_rasterizer = RASTERIZER_SCANLINE;
+
+	// once the count wraps, every tile is emptied straight away
+	drawMatrix(background);
+	g_zbuffer->generation = UINT_MAX;
+	clearZBuffer(g_zbuffer);
+	int wrapped = g_zbuffer->generation == 0 &&
+		g_zbuffer->depth[stale] == ZBUFFER_EMPTY &&
+		g_zbuffer->color[stale] == 0;
+
+	freeMatrix(background);
+	freeMatrix(sprite);
+	return identical && lazy && wrapped;
+}
+
+static int testDirtyRects(void){
+	int numTiles = ((g_screenWidth + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE) *
+			((g_screenHeight + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE),
+		numPixels = g_screenWidth * g_screenHeight,
+		width = g_screenWidth + 24;
+	PixelRect_t *rects = malloc(numTiles * sizeof(PixelRect_t));
+	char *drawn = malloc(numPixels), *changed = malloc(numPixels),
+		*tileDrawn = calloc(numTiles, 1);
+	uint32_t *color = malloc((size_t)width * g_screenHeight *
+		sizeof(uint32_t));
+	Matrix_t *sprite = createMatrix();
+	addSphere(sprite, POINT(100, 50, 0), 20);
+
+	// a sprite, and a line across its rows, drawn into rows padded like the
+	// SDL screen's may be, and into a buffer of its own
+	ZBuffer_t *screen = g_zbuffer, *padded = createZBufferOn(color, width),
+		*expected = createZBuffer();
+	g_zbuffer = expected;
+	drawMatrix(sprite);
+	drawLine(POINT(-200, 40, 0), POINT(0, 60, 0));
+	g_zbuffer = padded;
+	drawMatrix(sprite);
+	drawLine(POINT(-200, 40, 0), POINT(0, 60, 0));
+	g_zbuffer = screen;
+
+	// the padded plane, as the screen would read it, has empty pixels black
+	int same = 1, x, y;
+	for(y = 0; y < g_screenHeight; y++)
+		for(x = 0; x < g_screenWidth; x++){
+			int pixel = pixelColor(expected, x, y);
+			same = same && pixel == pixelColor(padded, x, y) &&
+				color[y * width + x] == (uint32_t)((pixel == -1)?0:pixel);
+			drawn[y * g_screenWidth + x] = pixel != -1;
+			tileDrawn[y / DEPTH_TILE_SIZE * padded->tileColumns +
+				x / DEPTH_TILE_SIZE] |= pixel != -1;
+		}
+
+	// the sprite's frame, a frame without changes, the clear that empties
+	// the sprite, and a clear of an empty buffer
+	int frame, valid = 1;
+	for(frame = 0; frame < 4; frame++){
+		if(frame >= 2)
+			clearZBuffer(padded);
+		int numRects = takeDirtyRects(padded, rects), area = 0, rect;
+		memset(changed, 0, numPixels);
+		for(rect = 0; rect < numRects; rect++){
+			valid = valid && rects[rect].minX <= rects[rect].maxX &&
+				rects[rect].maxX < g_screenWidth &&
+				rects[rect].minY <= rects[rect].maxY &&
+				rects[rect].maxY < g_screenHeight;
+			area += (rects[rect].maxX - rects[rect].minX + 1) *
+				(rects[rect].maxY - rects[rect].minY + 1);
+			for(y = rects[rect].minY; y <= rects[rect].maxY; y++)
+				for(x = rects[rect].minX; x <= rects[rect].maxX; x++)
+					changed[y * g_screenWidth + x] = 1;
+		}
+
+		// the clear changes exactly the tiles that were drawn to
+		if(frame == 0 || frame == 2){
+			for(y = 0; y < g_screenHeight; y++)
+				for(x = 0; x < g_screenWidth; x++){
+					int pixel = y * g_screenWidth + x;
+					valid = valid && (!drawn[pixel] || changed[pixel]) &&
+						(frame == 0 || changed[pixel] ==
+							tileDrawn[y / DEPTH_TILE_SIZE *
+								padded->tileColumns + x / DEPTH_TILE_SIZE]);
+				}
+			valid = valid && numRects > 0 && area < numPixels / 16;
+		}
+		else
+			valid = valid && numRects == 0;
+	}
+
+	freeZBuffer(padded);
+	freeZBuffer(expected);
+	freeMatrix(sprite);
+	free(rects);
+	free(drawn);
+	free(changed);
+	free(tileDrawn);
+	free(color);
+	return same && valid;
+}
+
+static int testScreenFormat(void){
+	// 0xRRGGBB; then 0xBBGGRR, 24- and 16-bit pixels, and 0xRRGGBBAA
+	return matchesColorPlane(4, 0xFF0000, 0xFF00, 0xFF) &&
+		!matchesColorPlane(4, 0xFF, 0xFF00, 0xFF0000) &&
+		!matchesColorPlane(3, 0xFF0000, 0xFF00, 0xFF) &&
+		!matchesColorPlane(2, 0xF800, 0x7E0, 0x1F) &&
+		!matchesColorPlane(4, 0xFF000000, 0xFF0000, 0xFF00);
+}
+
+static int testDrawMesh(void){
+	Mesh_t *mesh = createMesh();
+	addRectangularPrismMesh(mesh, POINT(0, 0, 300), POINT(20, 40, 60));
+	addSphereMesh(mesh, POINT(0, 0, 0), 80);
+	addTorusMesh(mesh, POINT(20, 20, 200), 30, 20);
+	drawMesh(mesh);
+	freeMesh(mesh);
+	ASSERT_EQUAL_SCREEN("testDrawMesh.csv");
+}
+
 static int testLighting(void){
-	RGB_t *rgb = lightColor(POINT(4.829418, -99.829080, 173.387531), POINT(0.007227, -0.955292, -0.295575, 0.000000));
-	int equal = rgb[R] == 233 && rgb[G] == 233 && rgb[B] == 255;
-	free(rgb);
-	return equal;
+	RGB_t rgb[3];
+	lightColor(POINT(4.829418, -99.829080, 173.387531), POINT(0.007227, -0.955292, -0.295575, 0.000000), rgb);
+	return rgb[R] == 233 && rgb[G] == 233 && rgb[B] == 255;
+}
+
+static int testFastMath(void){
+	double sinError = 0, tanError = 0, invSqrtError = 0, powError = 0;
+	int exact = 1, sample;
+	for(sample = -5000; sample <= 5000; sample++){
+		double angle = sample * (4 * M_PI / 5000) + 0.1234;
+		sinError = fmax(sinError, fabs(fastSin(angle) - sin(angle)));
+		sinError = fmax(sinError, fabs(fastCos(angle) - cos(angle)));
+		exact = exact && mathSin(angle) == sin(angle) &&
+			mathCos(angle) == cos(angle) && mathTan(angle) == tan(angle);
+
+		// tangents of angles within 1.4 radians of 0 (mod pi)
+		double narrow = sample * (1.4 / 5000);
+		tanError = fmax(tanError, fabs(fastTan(narrow) / tan(narrow) - 1));
+
+		double value = pow(10, sample / 1000.0);
+		invSqrtError = fmax(invSqrtError,
+			fabs(fastInvSqrt(value) * sqrt(value) - 1));
+
+		double base = sample / 5000.0;
+		powError = fmax(powError, fabs(powInt(base, 100) - pow(base, 100)));
+		exact = exact && mathPowInt(base, 100) == pow(base, 100);
+	}
+
+	// the approximations shift a lit color by at most one level
+	RGB_t exactColor[3], fastColor[3];
+	lightColor(POINT(4.829418, -99.829080, 173.387531),
+		POINT(0.007227, -0.955292, -0.295575, 0), exactColor);
+	g_fastMath = 1;
+	lightColor(POINT(4.829418, -99.829080, 173.387531),
+		POINT(0.007227, -0.955292, -0.295575, 0), fastColor);
+	g_fastMath = 0;
+
+	int color, lit = 1;
+	for(color = 0; color < 3; color++)
+		lit = lit && abs(exactColor[color] - fastColor[color]) <= 1;
+
+	return exact && lit && sinError < 1e-6 && tanError < 1e-5 &&
+		invSqrtError < 1e-8 && powError < 1e-12;
+}
+
+static int testFrameArena(void){
+	Matrix_t *points = createMatrix();
+	Mesh_t *mesh = createMesh();
+	Mat4_t rotation = rotationMat4(Y_AXIS, 30);
+
+	int allocationFree = 1, frame;
+	for(frame = 0; frame < 3; frame++){
+		AllocationStats_t before = g_allocationStats;
+
+		addRectangularPrismMesh(mesh, POINT(0, 0, 300), POINT(20, 40, 60));
+		transformMesh(&rotation, mesh);
+		drawMesh(mesh);
+		clearMesh(mesh);
+
+		addSphereMesh(mesh, POINT(0, 0, 0), 80);
+		transformMesh(&rotation, mesh);
+		drawMesh(mesh);
+		clearMesh(mesh);
+
+		addEdge(points, POINT(-100, -100, 0), POINT(100, 100, 0));
+		drawMatrix(points);
+		CLEAR(points);
+
+		clearZBuffer(g_zbuffer);
+		resetArena(&g_frameArena);
+
+		// the first frame sizes the containers and the arena
+		if(frame > 0)
+			allocationFree = allocationFree &&
+				g_allocationStats.systemAllocations ==
+					before.systemAllocations &&
+				g_allocationStats.arenaAllocations > before.arenaAllocations;
+	}
+
+	freeMatrix(points);
+	freeMesh(mesh);
+	return allocationFree;
 }
 
 static void configureTestingEnvironment(){
@@ -540,6 +1675,35 @@ static void configureTestingEnvironment(){
 	fclose(testConfig);
 
 	g_zbuffer = createZBuffer();
+
+	// the fixtures were recorded with exact math
+	g_fastMath = 0;
+}
+
+static int pixelColor(ZBuffer_t *zBuf, int x, int y){
+	currentTile(zBuf, x, y);
+	int pixel = ZBUFFER_PIXEL(zBuf, x, y);
+	return (zBuf->depth[pixel] == ZBUFFER_EMPTY)?-1:(int)zBuf->color[pixel];
+}
+
+static void copyPixels(ZBuffer_t *copy, ZBuffer_t *zBuf){
+	int numPixels = g_screenWidth * g_screenHeight,
+		numTiles = zBuf->tileColumns *
+			((g_screenHeight + DEPTH_TILE_SIZE - 1) / DEPTH_TILE_SIZE);
+	flushZBuffer(zBuf);
+	memcpy(copy->tiles, zBuf->tiles, numTiles * sizeof(*zBuf->tiles));
+	copy->generation = zBuf->generation;
+	memcpy(copy->depth, zBuf->depth, numPixels * sizeof(*zBuf->depth));
+	memcpy(copy->color, zBuf->color, numPixels * sizeof(*zBuf->color));
+}
+
+static int samePixels(ZBuffer_t *zBuf1, ZBuffer_t *zBuf2){
+	int numPixels = g_screenWidth * g_screenHeight;
+	flushZBuffer(zBuf1);
+	flushZBuffer(zBuf2);
+	return !memcmp(zBuf1->depth, zBuf2->depth,
+			numPixels * sizeof(*zBuf1->depth)) &&
+		!memcmp(zBuf1->color, zBuf2->color, numPixels * sizeof(*zBuf1->color));
 }
 
 int unitTests(void){
@@ -562,23 +1726,47 @@ int unitTests(void){
 	TEST(testEqualMatrix());
 	TEST(testPointsFileIO());
 	TEST(testAddPoint());
+	TEST(testReserveMatrix());
 	TEST(testAddPolygons());
 	TEST(testAddBezier());
 	TEST(testAddHermite());
+	TEST(testFlattenCurves());
 	TEST(testAddRectangularPrism());
 	TEST(testAddSphere());
 	TEST(testAddTorus());
+	TEST(testAddMesh());
+	TEST(testTransformMesh());
+	TEST(testTessellationCache());
+	TEST(testLevelOfDetail());
 	TEST(testCreateTranslation());
 	TEST(testCreateScale());
 	TEST(testCreateRotation());
 	TEST(testAddEdge());
 	TEST(testCreateIdentity());
+	TEST(testComposeMat4());
+	TEST(testInvertMat4());
+	TEST(testVertexKernels());
 	TEST(testZBufferIO());
 	TEST(testDrawLine());
+	TEST(testClippedLines());
 	TEST(testDrawHorizontalGradientLine());
+	TEST(testGradientSpan());
 	TEST(testScanLineRender());
+	TEST(testClippedScanlines());
+	TEST(testEdgeRasterizer());
+	TEST(testGuardBand());
 	TEST(testZBuffering());
+	TEST(testDepthCulling());
+	TEST(testTiledRendering());
+	TEST(testCamera());
+	TEST(testCullTriangles());
+	TEST(testDrawMesh());
+	TEST(testLazyClear());
+	TEST(testDirtyRects());
+	TEST(testScreenFormat());
 	TEST(testLighting());
+	TEST(testFastMath());
+	TEST(testFrameArena());
 	freeZBuffer(g_zbuffer);
 
 	if(hasColors)
@@ -593,3 +1781,4 @@ int unitTests(void){
 
 	return exitStatus;
 }
+